@@ -0,0 +1,205 @@
+// Copyright (c) 2023. Minh Nguyen
+// All rights reserved.
+
+// Times the CPU geometry generation of the drawable builders, without any OpenGL context, over a sweep of resolutions.
+// Every case is repeated until it has run for a while and reported in the manner of Google Benchmark:
+//
+//     CG2023GeometryBench [--filter <substring>] [--min-time <seconds>] [--help]
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "drawable/Cone.h"
+#include "drawable/Cube.h"
+#include "drawable/Cylinder.h"
+#include "drawable/Frustum.h"
+#include "drawable/Geometry.h"
+#include "drawable/Mesh.h"
+#include "drawable/Pyramid.h"
+#include "drawable/Sphere.h"
+
+namespace {
+    constexpr auto USAGE = std::string_view{
+        "Usage: CG2023GeometryBench [--filter <substring>] [--min-time <seconds>] [--help]\n"
+    };
+
+    struct Options {
+        // Only the cases whose name contains it run
+        std::string filter{};
+        double minTime{ 0.5 };
+        bool help{ false };
+    };
+
+    Options parseOptions(const int argc, char* argv[]) {
+        auto options = Options{};
+        for (auto i = 1; i < argc; ++i) {
+            const auto arg = std::string_view{ argv[i] };
+            if (arg == "--help") {
+                options.help = true;
+                continue;
+            }
+            if (i + 1 == argc) {
+                throw std::invalid_argument("Bench: Missing value for " + std::string{ arg });
+            }
+            const auto value = std::string_view{ argv[++i] };
+            if (arg == "--filter") {
+                options.filter = value;
+            } else if (arg == "--min-time") {
+                const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), options.minTime);
+                if (error != std::errc{} || end != value.data() + value.size() || !(options.minTime > 0.0)) {
+                    throw std::invalid_argument(
+                        "Bench: --min-time takes a positive number of seconds, not " + std::string{ value }
+                    );
+                }
+            } else {
+                throw std::invalid_argument("Bench: Unknown option " + std::string{ arg });
+            }
+        }
+        return options;
+    }
+
+    struct Case {
+        std::string name;
+        std::function<Geometry()> generate;
+    };
+
+    std::vector<Case> makeCases() {
+        auto cases = std::vector<Case>{};
+
+        for (const auto segments : { 16, 64, 256, 1024 }) {
+            cases.push_back({ "Mesh/segments:" + std::to_string(segments), [segments] {
+                return Mesh::Builder([](const float x, const float y) { return std::sin(x) * std::cos(y); })
+                        .halfExtent(10.0f)
+                        .segments(segments)
+                        .generate();
+            }});
+        }
+        for (const auto latitudes : { 8, 32, 128, 512 }) {
+            cases.push_back({ "GeographicSphere/latitudes:" + std::to_string(latitudes), [latitudes] {
+                return Sphere::GeographicBuilder().latitudes(latitudes).longitudes(2 * latitudes).generate();
+            }});
+        }
+        for (auto depth = 1; depth <= 7; ++depth) {
+            cases.push_back({ "SubdivisionSphere/depth:" + std::to_string(depth), [depth] {
+                return Sphere::SubdivisionBuilder()
+                        .initialPolygon(Sphere::SubdivisionBuilder::Polyhedron::ICOSAHEDRON)
+                        .recursiveDepth(depth)
+                        .generate();
+            }});
+        }
+        // A uniform color lets the faces share their edge vertices, which the per-face hues above don't
+        for (auto depth = 1; depth <= 7; ++depth) {
+            cases.push_back({ "UniformSubdivisionSphere/depth:" + std::to_string(depth), [depth] {
+                return Sphere::SubdivisionBuilder()
+                        .initialPolygon(Sphere::SubdivisionBuilder::Polyhedron::ICOSAHEDRON)
+                        .recursiveDepth(depth)
+                        .uniformColor(1.0f, 1.0f, 1.0f)
+                        .generate();
+            }});
+        }
+        for (const auto segments : { 16, 64, 256, 1024 }) {
+            cases.push_back({ "Cylinder/segments:" + std::to_string(segments), [segments] {
+                return Cylinder::Builder().segments(segments).generate();
+            }});
+            cases.push_back({ "Cone/segments:" + std::to_string(segments), [segments] {
+                return Cone::Builder().segments(segments).generate();
+            }});
+        }
+        cases.push_back({ "Cube", [] { return Cube::Builder().generate(); } });
+        cases.push_back({ "Pyramid", [] { return Pyramid::Builder().generate(); } });
+        cases.push_back({ "Frustum", [] { return Frustum::Builder().generate(); } });
+
+        return cases;
+    }
+
+    // Prints a duration with the unit Google Benchmark would pick
+    std::string formatTime(const double nanos) {
+        auto stream = std::ostringstream{};
+        stream << std::fixed << std::setprecision(0);
+        if (nanos >= 1e6) {
+            stream << nanos / 1e6 << " ms";
+        } else if (nanos >= 1e3) {
+            stream << nanos / 1e3 << " us";
+        } else {
+            stream << nanos << " ns";
+        }
+        return stream.str();
+    }
+
+    std::string formatRate(const double perSecond) {
+        auto stream = std::ostringstream{};
+        stream << std::fixed << std::setprecision(2);
+        if (perSecond >= 1e9) {
+            stream << perSecond / 1e9 << "G/s";
+        } else if (perSecond >= 1e6) {
+            stream << perSecond / 1e6 << "M/s";
+        } else if (perSecond >= 1e3) {
+            stream << perSecond / 1e3 << "k/s";
+        } else {
+            stream << perSecond << "/s";
+        }
+        return stream.str();
+    }
+}
+
+int main(const int argc, char* argv[]) {
+    auto options = Options{};
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << '\n' << USAGE;
+        return 2;
+    }
+    if (options.help) {
+        std::cout << USAGE;
+        return 0;
+    }
+
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right << std::setw(12) << "Time"
+              << std::setw(12) << "Iterations" << std::setw(12) << "Vertices" << std::setw(16) << "Vertices/s" << '\n'
+              << std::string(92, '-') << '\n';
+
+    // Keeps the generated geometry observable so that the work can't be optimized away
+    volatile auto sink = std::size_t{ 0 };
+    for (const auto& [name, generate] : makeCases()) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        // The first run warms the caches and the thread pool up and tells how many vertices a run makes
+        const auto vertexCount = generate().getVertexCount();
+
+        auto iterations = std::int64_t{ 0 };
+        auto elapsed = std::chrono::nanoseconds{ 0 };
+        const auto target = std::chrono::duration<double>(options.minTime);
+        while (elapsed < target) {
+            // Batches grow so that short cases don't spend their time reading the clock
+            const auto batch = std::max<std::int64_t>(iterations, 1);
+            const auto start = std::chrono::steady_clock::now();
+            for (auto i = std::int64_t{ 0 }; i < batch; ++i) {
+                sink = sink + generate().indices.size();
+            }
+            elapsed += std::chrono::steady_clock::now() - start;
+            iterations += batch;
+        }
+
+        const auto nanosPerIteration = static_cast<double>(elapsed.count()) / static_cast<double>(iterations);
+        const auto verticesPerSecond = static_cast<double>(vertexCount) * 1e9 / nanosPerIteration;
+        std::cout << std::left << std::setw(40) << name << std::right << std::setw(12) << formatTime(nanosPerIteration)
+                  << std::setw(12) << iterations << std::setw(12) << vertexCount
+                  << std::setw(16) << formatRate(verticesPerSecond) << '\n';
+    }
+
+    return 0;
+}
@@ -0,0 +1,306 @@
+// Copyright (c) 2023. Minh Nguyen
+// All rights reserved.
+
+// Renders a canned scene off-screen for a fixed number of frames and prints frame time percentiles, build time and
+// peak memory as JSON, so that runs can be compared across commits:
+//
+//     CG2023Bench --entities 500 --segments 200 --lights 16 --trace 1000 --frames 600 > result.json
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "Context.h"
+#include "Engine.h"
+#include "EntityManager.h"
+#include "LightManager.h"
+#include "RenderableManager.h"
+#include "Skybox.h"
+
+#include "drawable/Cube.h"
+#include "drawable/Material.h"
+#include "drawable/Mesh.h"
+#include "drawable/Sphere.h"
+#include "drawable/Trace.h"
+
+namespace {
+    constexpr auto USAGE = std::string_view{
+        "Usage: CG2023Bench [--entities <n>] [--segments <n>] [--lights <n>] [--trace <n>] [--frames <n>]\n"
+        "                   [--warmup <n>] [--width <px>] [--height <px>] [--backend native|egl|osmesa] [--help]\n"
+    };
+
+    struct Options {
+        int entities{ 100 };
+        int segments{ 100 };
+        int lights{ 4 };
+        int trace{ 256 };
+        int frames{ 300 };
+        // Frames rendered before measuring, to leave out shader compilation and first uploads
+        int warmup{ 30 };
+        int width{ 1280 };
+        int height{ 720 };
+        Context::Backend backend{ Context::Backend::NATIVE };
+        bool help{ false };
+    };
+
+    Options parseOptions(const int argc, char* argv[]) {
+        auto options = Options{};
+        for (auto i = 1; i < argc; ++i) {
+            const auto arg = std::string_view{ argv[i] };
+            if (arg == "--help") {
+                options.help = true;
+                continue;
+            }
+            if (i + 1 == argc) {
+                throw std::invalid_argument("Bench: Missing value for " + std::string{ arg });
+            }
+            const auto value = std::string_view{ argv[++i] };
+            // The whole value must be an integer no less than min
+            const auto number = [&arg, &value](const int min) {
+                auto result = 0;
+                const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+                if (error != std::errc{} || end != value.data() + value.size() || result < min) {
+                    throw std::invalid_argument(
+                        "Bench: " + std::string{ arg } + " takes an integer of at least " + std::to_string(min)
+                        + ", not " + std::string{ value }
+                    );
+                }
+                return result;
+            };
+            if (arg == "--entities") options.entities = number(0);
+            else if (arg == "--segments") options.segments = number(1);
+            else if (arg == "--lights") options.lights = number(0);
+            else if (arg == "--trace") options.trace = number(0);
+            else if (arg == "--frames") options.frames = number(1);
+            else if (arg == "--warmup") options.warmup = number(0);
+            else if (arg == "--width") options.width = number(1);
+            else if (arg == "--height") options.height = number(1);
+            else if (arg == "--backend") {
+                if (value == "native") options.backend = Context::Backend::NATIVE;
+                else if (value == "egl") options.backend = Context::Backend::EGL;
+                else if (value == "osmesa") options.backend = Context::Backend::OSMESA;
+                else throw std::invalid_argument("Bench: Unknown backend " + std::string{ value });
+            }
+            else throw std::invalid_argument("Bench: Unknown option " + std::string{ arg });
+        }
+        return options;
+    }
+
+    // In bytes
+    std::int64_t getPeakMemory() {
+#ifdef _WIN32
+        auto counters = PROCESS_MEMORY_COUNTERS{};
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return static_cast<std::int64_t>(counters.PeakWorkingSetSize);
+#else
+        auto usage = rusage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return static_cast<std::int64_t>(usage.ru_maxrss);
+#else
+        return static_cast<std::int64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    // Nearest-rank percentile of sorted samples
+    double percentile(const std::vector<double>& sorted, const double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    float surface(const float x, const float y) {
+        return std::sin(x / 2.0f) * std::cos(y / 2.0f);
+    }
+
+    // Everything the scene is made of, kept alive until the engine is destroyed
+    struct Bench {
+        std::vector<std::unique_ptr<Drawable>> drawables{};
+        std::vector<Entity> lights{};
+    };
+
+    void buildScene(const Options& options, Engine& engine, Scene& scene, Bench& bench) {
+        constexpr auto halfExtent = 20.0f;
+        const auto tm = engine.getTransformManager();
+
+        // The ground
+        auto mesh = Mesh::Builder(surface)
+                .halfExtent(halfExtent)
+                .segments(options.segments)
+                .shaderModel(Shader::Model::PHONG)
+                .phongMaterial(phong::TURQUOISE)
+                .build(engine);
+        scene.addEntity(mesh->getEntity());
+        bench.drawables.push_back(std::move(mesh));
+
+        // Cubes and spheres alternate over a square grid laid above the ground
+        const auto side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(options.entities))));
+        const auto spacing = 2.0f * halfExtent / static_cast<float>(std::max(side, 1));
+        for (auto i = 0; i < options.entities; ++i) {
+            auto drawable = i % 2 == 0
+                    ? Cube::Builder().shaderModel(Shader::Model::PHONG).phongMaterial(phong::COPPER).build(engine)
+                    : Sphere::GeographicBuilder().longitudes(32).latitudes(16)
+                            .shaderModel(Shader::Model::PHONG).phongMaterial(phong::OBSIDIAN).build(engine);
+            const auto x = -halfExtent + spacing * (static_cast<float>(i % side) + 0.5f);
+            const auto y = -halfExtent + spacing * (static_cast<float>(i / side) + 0.5f);
+            auto transform = glm::translate(glm::mat4(1.0f), glm::vec3{ x, y, surface(x, y) + 1.0f });
+            transform = glm::scale(transform, glm::vec3{ spacing * 0.3f });
+            tm->setTransform(drawable->getEntity(), transform);
+            scene.addEntity(drawable->getEntity());
+            bench.drawables.push_back(std::move(drawable));
+        }
+
+        // A sun, then point lights in a ring
+        const auto sun = EntityManager::get()->create();
+        LightManager::Builder(LightManager::Type::DIRECTIONAL)
+                .direction(1.0f, 0.5f, -0.5f)
+                .ambient(0.1f, 0.1f, 0.1f)
+                .build(sun);
+        scene.addEntity(sun);
+        bench.lights.push_back(sun);
+        for (auto i = 0; i < options.lights; ++i) {
+            const auto angle = 2.0f * glm::pi<float>() * static_cast<float>(i) / static_cast<float>(options.lights);
+            const auto light = EntityManager::get()->create();
+            LightManager::Builder(LightManager::Type::POINT)
+                    .position(halfExtent * 0.7f * std::cos(angle), halfExtent * 0.7f * std::sin(angle), 4.0f)
+                    .build(light);
+            scene.addEntity(light);
+            bench.lights.push_back(light);
+        }
+
+        // A trace winding over the ground, every mark an instance of the same quad
+        if (options.trace > 0) {
+            auto trace = Trace::Builder()
+                    .capacity(options.trace)
+                    .color(0.9f, 0.3f, 0.1f)
+                    .build(engine);
+            const auto renderableManager = engine.getRenderableManager();
+            for (auto i = 1; i < options.trace; ++i) {
+                const auto t = static_cast<float>(i) / static_cast<float>(options.trace);
+                const auto x = halfExtent * 0.8f * std::cos(12.0f * t) * t;
+                const auto y = halfExtent * 0.8f * std::sin(12.0f * t) * t;
+                const auto transform = Trace::getInstanceTransform(
+                    { x, y, surface(x, y) + 0.01f }, { -std::sin(12.0f * t), std::cos(12.0f * t), 0.0f },
+                    { 0.0f, 0.0f, 1.0f }, 0.15f
+                );
+                renderableManager->addInstance(trace->getEntity(), transform, { 0.9f, 0.3f, 0.1f, 1.0f });
+            }
+            scene.addEntity(trace->getEntity());
+            bench.drawables.push_back(std::move(trace));
+        }
+    }
+}
+
+int main(const int argc, char* argv[]) {
+    auto options = Options{};
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << '\n' << USAGE;
+        return 2;
+    }
+    if (options.help) {
+        std::cout << USAGE;
+        return 0;
+    }
+
+    // Machines without a GPU or a display end here, which should fail the run rather than abort it
+    auto context = std::unique_ptr<Context>{};
+    auto engine = std::unique_ptr<Engine>{};
+    try {
+        context = Context::createHeadless(
+            options.width, options.height, options.warmup + options.frames, std::chrono::nanoseconds{ 16'666'667 },
+            options.backend
+        );
+        engine = Engine::create();
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Bench: " << e.what() << '\n';
+        return 1;
+    }
+    const auto renderer = engine->createRenderer();
+
+    const auto buildStart = std::chrono::steady_clock::now();
+    const auto scene = engine->createScene();
+    auto bench = Bench{};
+    buildScene(options, *engine, *scene, bench);
+    const auto buildTime = std::chrono::steady_clock::now() - buildStart;
+
+    const auto camera = engine->createCamera(EntityManager::get()->create());
+    camera->setRadius(40.0f);
+    camera->setLatitudeAngle(35.0f);
+    const auto view = engine->createView();
+    view->setSkybox(Skybox::Builder().color(0.02f, 0.04f, 0.06f, 1.0f).build(*engine));
+    view->setCamera(camera);
+    view->setScene(scene);
+    context->setFramebufferCallback([&](const auto w, const auto h) {
+        camera->setProjection(45.0f, static_cast<float>(w) / static_cast<float>(h), 0.1f, 200.0f);
+        view->setViewport({ 0, 0, w, h });
+    });
+
+    // Every frame waits for the GPU so that its time covers the whole frame, not just the submission
+    auto frameTimes = std::vector<double>{};
+    frameTimes.reserve(options.frames);
+    auto frame = 0;
+    auto drawCalls = 0;
+    context->loop([&] {
+        const auto start = std::chrono::steady_clock::now();
+        renderer->render(*view);
+        glFinish();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if (frame++ >= options.warmup) {
+            frameTimes.push_back(std::chrono::duration<double, std::milli>(elapsed).count());
+        }
+        drawCalls = renderer->getStatistics().drawCalls;
+    });
+
+    auto sorted = frameTimes;
+    std::ranges::sort(sorted);
+    auto total = 0.0;
+    for (const auto time : frameTimes) {
+        total += time;
+    }
+
+    std::cout << "{\n"
+              << "  \"entities\": " << options.entities << ",\n"
+              << "  \"segments\": " << options.segments << ",\n"
+              << "  \"lights\": " << options.lights << ",\n"
+              << "  \"trace\": " << options.trace << ",\n"
+              << "  \"frames\": " << frameTimes.size() << ",\n"
+              << "  \"width\": " << options.width << ",\n"
+              << "  \"height\": " << options.height << ",\n"
+              << "  \"drawCalls\": " << drawCalls << ",\n"
+              << "  \"buildMillis\": " << std::chrono::duration<double, std::milli>(buildTime).count() << ",\n"
+              << "  \"frameMillis\": {\n"
+              << "    \"mean\": " << (frameTimes.empty() ? 0.0 : total / static_cast<double>(frameTimes.size())) << ",\n"
+              << "    \"p50\": " << percentile(sorted, 50.0) << ",\n"
+              << "    \"p95\": " << percentile(sorted, 95.0) << ",\n"
+              << "    \"p99\": " << percentile(sorted, 99.0) << ",\n"
+              << "    \"max\": " << (sorted.empty() ? 0.0 : sorted.back()) << "\n"
+              << "  },\n"
+              << "  \"peakMemoryBytes\": " << getPeakMemory() << "\n"
+              << "}\n";
+
+    // The engine frees whatever the scene is made of
+    engine->destroy();
+    return 0;
+}
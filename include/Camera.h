@@ -23,6 +23,12 @@ public:
 
 	[[nodiscard]] glm::mat4 getProjection() const;
 
+	// Distances to the clipping planes of the current projection
+	[[nodiscard]] float getNear() const;
+	[[nodiscard]] float getFar() const;
+
+	[[nodiscard]] bool isOrthographic() const;
+
 	[[nodiscard]] glm::mat4 getViewMatrix() const;
 
 	void relativeDrag(float offsetX, float offsetY);
@@ -52,6 +58,9 @@ private:
     float _dragSensitive{ 0.5f };
 
 	glm::mat4 _projection{ glm::perspective(glm::radians(DEFAULT_FOV), 1.0f, DEFAULT_NEAR, DEFAULT_FAR) };
+	float _near{ DEFAULT_NEAR };
+	float _far{ DEFAULT_FAR };
+	bool _orthographic{ false };
 
 	static constexpr auto MIN_RADIUS = 1.0f;
 	static constexpr auto MAX_RADIUS = 5000.0f;
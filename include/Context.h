@@ -5,6 +5,7 @@
 
 #include <glad/glad.h> // GLAD must be included before GLFW
 #include <GLFW/glfw3.h>
+#include <chrono>
 #include <string_view>
 #include <functional>
 #include <map>
@@ -34,13 +35,42 @@ public:
         X = GLFW_KEY_X,
         Z = GLFW_KEY_Z,
         SPACE = GLFW_KEY_SPACE,
-        F1 = GLFW_KEY_F1
+        F1 = GLFW_KEY_F1,
+        F2 = GLFW_KEY_F2
     };
     static std::unique_ptr<Context> create(
         std::string_view name = "Computer Graphics",
         int width = 800, int height = 600
     );
 
+    // The API used to create the OpenGL context of a headless Context
+    enum class Backend {
+        // The platform's default, through a hidden window
+        NATIVE,
+        // EGL, through a hidden window
+        EGL,
+        // Mesa's off-screen renderer, needs no display at all when GLFW is built with GLFW_USE_OSMESA
+        OSMESA,
+    };
+
+    /**
+     * Creates a context that renders into an off-screen framebuffer rather than a visible window. Its loop runs
+     * exactly frameCount frames, each advancing the time by frameTime regardless of how long it actually took.
+     * The framebuffer stays bound during the loop so captures read from it.
+     * @param width The width of the off-screen framebuffer
+     * @param height The height of the off-screen framebuffer
+     * @param frameCount The number of frames the loop runs
+     * @param frameTime The time every frame reports as elapsed
+     * @param backend The API used to create the OpenGL context
+     */
+    static std::unique_ptr<Context> createHeadless(
+        int width, int height, int frameCount,
+        std::chrono::nanoseconds frameTime = std::chrono::nanoseconds{ 16'666'667 },
+        Backend backend = Backend::NATIVE
+    );
+
+    [[nodiscard]] bool isHeadless() const;
+
     void setClose(bool close) const;
 
     void setFramebufferCallback(const std::function<void(int, int)>& callback) const;
@@ -53,10 +83,33 @@ public:
 
     void setMouseDragPerpetualCallback(const std::function<void(float, float)>& callback) const;
 
+    /**
+     * Runs the simulation at a fixed rate, independent of the frame rate. Before each frame the loop calls onStep as
+     * many times as whole steps have elapsed, and getInterpolationAlpha tells how far the frame is into the next one.
+     * @param step The simulated time per call, zero disables fixed steps
+     * @param onStep Called with the step in seconds, after the input listeners and before the frame
+     */
+    void setFixedStep(std::chrono::nanoseconds step, const std::function<void(float)>& onStep);
+
+    /**
+     * Caps the frame rate by sleeping out what is left of each frame, so that a mostly idle viewer doesn't keep a core
+     * busy. Headless contexts ignore the cap.
+     * @param framesPerSecond The highest frame rate, zero lifts the cap
+     */
+    void setFrameRateCap(int framesPerSecond);
+
     void loop(const std::function<void()>& onFrame);
 
+    [[nodiscard]] std::chrono::nanoseconds getDeltaTime() const;
+
+    [[nodiscard]] float getDeltaSeconds() const;
+
+    // Truncated to whole milliseconds, prefer getDeltaTime or getDeltaSeconds
     [[nodiscard]] long getDeltaTimeMillis() const;
 
+    // The fraction of a fixed step elapsed since the last one, to blend the last two simulated states with
+    [[nodiscard]] float getInterpolationAlpha() const;
+
     [[nodiscard]] std::pair<int, int> getFramebufferSize() const;
 
     static constexpr auto VERSION_MAJOR = 4;
@@ -65,11 +118,39 @@ public:
 private:
     Context(std::string_view name, int width, int height);
 
-    GLFWwindow* _window;
+    Context(int width, int height, int frameCount, std::chrono::nanoseconds frameTime, Backend backend);
+
+    void initialize(std::string_view name, int width, int height);
+
+    void loopHeadless(const std::function<void()>& onFrame);
+
+    GLFWwindow* _window{ nullptr };
+
+    bool _headless{ false };
+    int _frameCount{ 0 };
+    std::chrono::nanoseconds _frameTime{ 0 };
+    int _width{ 0 };
+    int _height{ 0 };
+
+    // The off-screen render target of a headless context
+    GLuint _framebuffer{ 0 };
+    GLuint _colorBuffer{ 0 };
+    GLuint _depthBuffer{ 0 };
+
+    std::chrono::nanoseconds _deltaTime{ 0 };
+
+    std::chrono::nanoseconds _step{ 0 };
+    std::function<void(float)> _onStep{};
+    // Elapsed time not simulated yet, always less than a step after the steps of a frame have run
+    std::chrono::nanoseconds _accumulator{ 0 };
+
+    // Steps run per frame at most, past that the simulation slows down rather than falling further behind
+    static constexpr auto MAX_STEPS_PER_FRAME = 8;
+
+    std::chrono::nanoseconds _minFrameTime{ 0 };
 
-    long _deltaTime{ 0l };
-    long _lastTime{ 0l };
-    long _currentTime{ 0l };
+    // Adds delta to the time left to simulate and runs the fixed steps it covers
+    void advance(std::chrono::nanoseconds delta);
 
     struct OnPressListener {
         const std::function<void()> callback;
@@ -3,9 +3,15 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <set>
+#include <span>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "Camera.h"
 #include "EntityManager.h"
@@ -59,16 +65,48 @@ public:
 
 	void destroyShader(Shader* shader);
 
+	/**
+	 * Destroys many shaders at once, along with the programs none of the remaining shaders use.
+	 * @param shaders - the shaders, null ones are skipped.
+	 */
+	void destroyShaders(std::span<Shader* const> shaders);
+
 	[[nodiscard]] Camera* createCamera(Entity entity);
 
 	void destroyCamera(Entity entity);
 
+	// Creates count new entities
+	[[nodiscard]] std::vector<Entity> createEntities(int count) const;
+
 	void destroyEntity(Entity entity) const;
 
+	/**
+	 * Destroys the components of many entities at once: their GL objects go in one delete call per kind and every
+	 * component array is compacted once. The entities themselves still need discarding through the EntityManager.
+	 * @param entities - the entities, those without components are skipped.
+	 */
+	void destroyEntities(std::span<const Entity> entities) const;
+
     void destroyTexture(Texture* texture);
 
 	void destroy();
 
+	struct ProgramStatistics {
+		int cacheHits{ 0 };
+		int cacheMisses{ 0 };
+		// Time spent loading and compiling programs
+		double millis{ 0.0 };
+	};
+
+	[[nodiscard]] const ProgramStatistics& getProgramStatistics() const;
+
+	/**
+	 * Sets where linked program binaries are cached between launches. Programs whose sources and driver match an
+	 * entry are loaded with glProgramBinary instead of being compiled again.
+	 * @param directory - the cache directory, created when needed. An empty path disables the cache.
+	 */
+	void setProgramCacheDirectory(std::string_view directory);
+
 private:
 	explicit Engine();
 
@@ -96,6 +134,13 @@ private:
 
 	std::set<Shader*> _shaders{};
 
+	// Linked programs shared by the Shaders of the same model and features
+	std::map<std::pair<Shader::Model, unsigned>, Shader::Program*> _programs{};
+
+	std::string _programCacheDirectory{ "./cache/programs" };
+
+	ProgramStatistics _programStatistics{};
+
     std::set<Texture*> _textures{};
 
 	friend class IndexBuffer;
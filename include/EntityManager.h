@@ -3,8 +3,13 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
 
+// An index in the low INDEX_BITS bits and the generation of that index in the others, so that a handle to a discarded
+// entity never matches the entity its index is recycled for
 using Entity = unsigned int;
 
 class EntityManager {
@@ -19,27 +24,39 @@ public:
 
 	[[nodiscard]] Entity create();
 
+	// Fills the span with new entities
+	void create(std::span<Entity> entities);
+
 	[[nodiscard]] bool isAlive(Entity entity) const;
 
+	// Makes the entity's index available for recycling, its components should be destroyed through the Engine first
 	void discard(Entity entity);
 
-private:
-	enum class Component {
-		RENDERABLE,
-		LIGHT,
-		NONE
-	};
+	void discard(std::span<const Entity> entities);
+
+	static constexpr auto INDEX_BITS = 24u;
+
+	[[nodiscard]] static std::uint32_t getIndex(const Entity entity) {
+		return entity & ((1u << INDEX_BITS) - 1);
+	}
 
+	[[nodiscard]] static std::uint32_t getGeneration(const Entity entity) {
+		return entity >> INDEX_BITS;
+	}
+
+private:
 	EntityManager() = default;
 
-	Entity _next{ 0 };
+	// Indices are recycled only once this many are free, so that each index goes through its generations slowly
+	static constexpr auto MIN_FREE_INDICES = std::size_t{ 1024 };
+
+	// The current generation of every index ever handed out
+	std::vector<std::uint8_t> _generations{};
 
-	std::unordered_map<Entity, Component> _entities{};
+	// Discarded indices, oldest first
+	std::deque<std::uint32_t> _freeIndices{};
 
 	inline static EntityManager* _instance{ nullptr };
 
 	friend class Engine;
-	friend class LightManager;
-	friend class RenderableManager;
-	friend class Scene;
-};
\ No newline at end of file
+};
@@ -20,6 +20,13 @@ public:
 
 		Builder& indexType(IndexType type);
 
+		/**
+		 * Picks the smallest index type able to address every vertex, leaving the largest value of the type free for
+		 * primitive restart.
+		 * @param vertexCount - the number of vertices the indices refer to.
+		 */
+		Builder& fitIndexType(int vertexCount);
+
 		IndexBuffer* build(Engine& engine) const;
 
 	private:
@@ -32,10 +39,20 @@ public:
 
 	[[nodiscard]] Builder::IndexType getIndexType() const;
 
+	[[nodiscard]] int getIndexCount() const;
+
+	/**
+	 * Uploads the indices, converted to the buffer's index type if needed. Primitive restart indices are converted to
+	 * the restart index of that type.
+	 * @param buffer - getIndexCount() indices.
+	 */
 	void setBuffer(const unsigned int* buffer) const;
 
 	void setBuffer(const unsigned short* buffer) const;
 
+	// The largest number of vertices 16-bit indices can address, the largest value being the primitive restart index
+	static constexpr auto MAX_USHORT_VERTICES = 0xFFFF;
+
 private:
 	explicit IndexBuffer(const GLuint ibo, const int count, const Builder::IndexType type)
 	: _ibo{ ibo }, _indexCount { count }, _indexType{ type } {}
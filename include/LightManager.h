@@ -5,9 +5,9 @@
 
 #include <array>
 #include <glm/vec3.hpp>
-#include <memory>
 
 #include "EntityManager.h"
+#include "SparseSet.h"
 
 class LightManager {
 public:
@@ -87,10 +87,11 @@ private:
 
 	static LightManager* getInstance();
 
-	std::unordered_map<Entity, std::unique_ptr<DirectionalLight>> _directionalLights{};
+	SparseSet<DirectionalLight> _directionalLights{};
 
-	std::unordered_map<Entity, std::unique_ptr<PointLight>> _pointLights{};
+	SparseSet<PointLight> _pointLights{};
 
 	friend class Engine;
 	friend class Renderer;
+	friend class Scene;
 };
\ No newline at end of file
@@ -4,13 +4,16 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <memory>
 #include <vector>
-#include <unordered_map>
 
 #include "EntityManager.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "SparseSet.h"
 #include "VertexBuffer.h"
 
 class RenderableManager {
@@ -20,11 +23,32 @@ class RenderableManager {
 		const std::size_t count;
 		const int offset;
 		const GLenum indexType;
+		// Added to every index, which lets 16-bit indices address vertices beyond the first 65536
+		const GLint baseVertex;
+		// Streaming vertex buffers have their current regions rebound before each draw
+		const VertexBuffer* const vertices;
+	};
+
+	// Per-instance attributes, laid out as the INSTANCE_TRANSFORM and INSTANCE_COLOR vertex attributes expect
+	struct Instance {
+		glm::mat4 transform;
+		glm::vec4 color;
 	};
 
 	struct Mesh {
-		const std::vector<std::unique_ptr<Element>> elements;
-		const std::vector<Shader*> shaders;
+		std::vector<std::unique_ptr<Element>> elements;
+		std::vector<Shader*> shaders;
+
+		// Instanced renderables draw every element once per instance, sourcing the per-instance attributes from
+		// this buffer. The buffer stays 0 for regular renderables.
+		GLuint instanceBuffer{ 0 };
+		std::vector<Instance> instances{};
+		std::size_t instanceCapacity{ 0 };
+
+		// Local-space bounding box used for culling, renderables without one are never culled
+		bool bounded{ false };
+		glm::vec3 boundsMin{ 0.0f };
+		glm::vec3 boundsMax{ 0.0f };
 	};
 
 public:
@@ -53,9 +77,33 @@ public:
 			const VertexBuffer& vertices,
 			const IndexBuffer& indices,
 			int count, 
-			int offset
+			int offset,
+			int baseVertex = 0
 		);
 
+		/**
+		 * Makes this renderable instanced: all of its elements get drawn once per instance added through
+		 * RenderableManager::addInstance, in a single draw call each.
+		 * @param capacity - the number of instances to allocate room for up front, the buffer grows when exceeded.
+		 */
+		Builder& instanced(int capacity);
+
+		Builder& boundingBox(const glm::vec3& min, const glm::vec3& max);
+
+		/**
+		 * Sets the bounding box to enclose the given vertex positions, non-finite positions are skipped.
+		 * @param positions - tightly packed x, y, z positions, as uploaded to the POSITION attribute.
+		 */
+		Builder& boundingBox(const std::vector<float>& positions);
+
+		/**
+		 * Sets the bounding box to enclose strided FLOAT3 positions, such as those of an interleaved buffer.
+		 * @param positions - the position of the first vertex.
+		 * @param count - the number of vertices.
+		 * @param byteStride - the distance in bytes between two consecutive positions.
+		 */
+		Builder& boundingBox(const void* positions, int count, int byteStride);
+
 		void build(Entity entity);
 
 	private:
@@ -63,6 +111,12 @@ public:
 
 		std::vector<Shader*> _shaders;
 
+		int _instanceCapacity{ 0 };
+
+		bool _bounded{ false };
+		glm::vec3 _boundsMin{ 0.0f };
+		glm::vec3 _boundsMax{ 0.0f };
+
 		static std::pair<int, int> resolveAttributeType(VertexBuffer::AttributeType type);
 
 		static int resolveIndexSize(IndexBuffer::Builder::IndexType type);
@@ -70,6 +124,12 @@ public:
 
 	[[nodiscard]] bool hasComponent(Entity entity) const;
 
+	void addInstance(Entity entity, const glm::mat4& transform, const glm::vec4& color);
+
+	void clearInstances(Entity entity);
+
+	[[nodiscard]] int getInstanceCount(Entity entity) const;
+
 private:
 	RenderableManager() = default;
 
@@ -77,8 +137,9 @@ private:
 
 	static RenderableManager* getInstance();
 
-	std::unordered_map<Entity, std::unique_ptr<Mesh>> _meshes{};
+	SparseSet<Mesh> _meshes{};
 
 	friend class Engine;
 	friend class Renderer;
+	friend class Scene;
 };
\ No newline at end of file
@@ -5,7 +5,16 @@
 
 #include <array>
 #include <glad/glad.h>
-
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <utility>
+#include <vector>
+
+#include "EntityManager.h"
+#include "RenderableManager.h"
+#include "Shader.h"
 #include "View.h"
 
 class Renderer {
@@ -33,16 +42,161 @@ public:
 
 	void togglePolygonMode();
 
-	void render(const View& view) const;
+	void render(const View& view);
+
+	struct Statistics {
+		int drawCalls{ 0 };
+		// Program, VAO and texture binds actually issued
+		int stateChanges{ 0 };
+		// Binds skipped because the state cache already had them bound
+		int stateChangesAvoided{ 0 };
+		// Renderables of the view that passed and failed the frustum test
+		int visible{ 0 };
+		int culled{ 0 };
+		// Triangles submitted, counting restart indices in strips as if they were vertices
+		std::int64_t triangles{ 0 };
+	};
+
+	/**
+	 * Returns the counters gathered by the last call to render(). Sum them over all views to get the per-frame figures.
+	 */
+	[[nodiscard]] Statistics getStatistics() const;
 
     static void readFramebufferRgba(int x, int y, int width, int height, unsigned char* data);
 
 private:
-	Renderer() = default;
+	Renderer();
 
 	ClearOptions _clearOptions{};
 
 	PolygonMode _polygonMode{ PolygonMode::FILL };
 
+	// Uniform buffers backing the Camera and Lights blocks declared in the shaders. They are written once per
+	// render(View) and shared by every program, the binding points must match those in res/shaders.
+	GLuint _cameraBlock{ 0 };
+	GLuint _lightBlock{ 0 };
+
+	// Storage buffers backing the clustered point lights: the lights themselves, the range of the light index list
+	// each cluster owns, and that list
+	GLuint _pointLightBuffer{ 0 };
+	GLuint _clusterBuffer{ 0 };
+	GLuint _lightIndexBuffer{ 0 };
+
+	// Whether the lights beyond the supported directional ones were reported already
+	bool _directionalLightsDropped{ false };
+
+	static constexpr GLuint CAMERA_BLOCK_BINDING = 0;
+	static constexpr GLuint LIGHT_BLOCK_BINDING  = 1;
+	static constexpr GLuint POINT_LIGHT_BINDING  = 2;
+	static constexpr GLuint CLUSTER_BINDING      = 3;
+	static constexpr GLuint LIGHT_INDEX_BINDING  = 4;
+
+	// The view is split into CLUSTER_X by CLUSTER_Y screen tiles, each cut into CLUSTER_Z depth slices
+	static constexpr auto CLUSTER_X = 16;
+	static constexpr auto CLUSTER_Y = 9;
+	static constexpr auto CLUSTER_Z = 24;
+
+	// A single draw of an element, sorted by its key before submission so that draws sharing the same program,
+	// textures and VAO end up next to each other.
+	struct DrawCommand {
+		std::uint64_t key;
+		Shader* shader;
+		const RenderableManager::Element* element;
+		glm::mat4 modelMat;
+		glm::mat4 normalMat;
+		// The number of instances to draw, 0 for a regular non-instanced draw
+		GLsizei instanceCount;
+	};
+
+	std::vector<DrawCommand> _queue{};
+
+	// A renderable of the current view along with its world transform, waiting for the frustum test
+	struct Candidate {
+		Entity entity;
+		glm::mat4 modelMat;
+	};
+
+	std::vector<Candidate> _candidates{};
+
+	// World-space bounding boxes of the candidates, kept in structure-of-arrays form so that the plane tests run over
+	// contiguous floats and vectorize.
+	struct BoundsArray {
+		std::vector<float> centerX, centerY, centerZ;
+		std::vector<float> extentX, extentY, extentZ;
+
+		void clear();
+
+		void push(const glm::vec3& center, const glm::vec3& extent);
+	};
+
+	BoundsArray _bounds{};
+
+	std::vector<std::uint8_t> _visibility{};
+
+	// Marks in _visibility which of the _bounds intersect the frustum of the given view-projection matrix
+	void cull(const glm::mat4& viewProjection);
+
+	static constexpr auto MAX_TEXTURE_UNITS = 16;
+
+	// The GL bindings issued by the last draw of the current render() call
+	struct StateCache {
+		GLuint program{ 0 };
+		GLuint vao{ 0 };
+		std::array<std::pair<GLenum, GLuint>, MAX_TEXTURE_UNITS> textures{};
+		const Shader* shader{ nullptr };
+	};
+
+	StateCache _cache{};
+
+	Statistics _statistics{};
+
+	static std::uint64_t makeSortKey(const Shader& shader, GLuint vao, float depth);
+
+	void submit(const DrawCommand& command);
+
+	void bindProgram(GLuint program);
+
+	void bindVertexArray(GLuint vao);
+
+	void bindTexture(int unit, GLenum target, GLuint texture);
+
+	void updateCameraBlock(const Camera& camera) const;
+
+	// Camera-space light data of the current view in structure-of-arrays form, prepared once per render(View) so that
+	// nothing downstream depends on the view matrix
+	struct LightArray {
+		std::vector<float> directionX, directionY, directionZ;
+		std::vector<glm::vec3> directionalAmbient, directionalDiffuse, directionalSpecular;
+
+		std::vector<float> positionX, positionY, positionZ;
+		std::vector<glm::vec3> pointAmbient, pointDiffuse, pointSpecular;
+		std::vector<float> constant, linear, quadratic;
+		// Distance beyond which the attenuated light no longer makes a visible difference
+		std::vector<float> radius;
+
+		void clear();
+	};
+
+	LightArray _lights{};
+
+	// Gathers the lights of the scene into _lights and moves them to camera space
+	void prepareLights(const Scene& scene, const glm::mat4& viewMat);
+
+	// Offset into _lightIndices and light count of every cluster, two values per cluster
+	std::vector<GLuint> _clusterRanges{};
+
+	// The point lights affecting each cluster, cluster after cluster
+	std::vector<GLuint> _lightIndices{};
+
+	// Scale and bias mapping view depth to a depth slice, along with the clipping distances
+	glm::vec4 _clusterDepth{ 0.0f };
+
+	bool _logarithmicSlices{ true };
+
+	// Bins the prepared point lights into the clusters of the camera's frustum they may light
+	void assignLights(const Camera& camera);
+
+	void updateLightBlock(const Viewport& viewport);
+
 	friend class Engine;
 };
\ No newline at end of file
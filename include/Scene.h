@@ -4,6 +4,7 @@
 #pragma once
 
 #include <set>
+#include <span>
 
 #include "EntityManager.h"
 
@@ -19,6 +20,8 @@ public:
 
 	void removeEntity(Entity entity);
 
+	void removeEntities(std::span<const Entity> entities);
+
 	[[nodiscard]] bool hasEntity(Entity entity) const;
 
 private:
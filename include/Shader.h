@@ -3,7 +3,11 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <glad/glad.h>
+#include <map>
 #include <string>
 #include <vector>
 #include <utility>
@@ -19,88 +23,159 @@ public:
 		PHONG
 	};
 
+	// Compile-time variants of a shader model, each one adds a #define of its name to the program sources
+	enum class Feature : unsigned {
+		TEXTURED  = 1u << 0,
+		INSTANCED = 1u << 1,
+		// Normals come in as VertexBuffer::AttributeType::OCTAHEDRAL and are unfolded in the vertex shader
+		OCTAHEDRAL_NORMALS = 1u << 2,
+	};
+
 	class Uniform {
 	public:
-        static constexpr auto MATERIAL_AMBIENT   = "material.ambient";
-        static constexpr auto MATERIAL_DIFFUSE   = "material.diffuse";
-        static constexpr auto MATERIAL_SPECULAR  = "material.specular";
-        static constexpr auto MATERIAL_SHININESS = "material.shininess";
+        /**
+         * A typed handle to one of the uniforms known to every shader model. Each Shader resolves the locations of
+         * all handles once when its program is linked, so setting a uniform through a handle is a plain array access
+         * rather than a glGetUniformLocation call.
+         */
+        struct Id {
+            int index;
+            const char* name;
+        };
+
+        static constexpr auto MATERIAL_AMBIENT   = Id{ 0, "material.ambient" };
+        static constexpr auto MATERIAL_DIFFUSE   = Id{ 1, "material.diffuse" };
+        static constexpr auto MATERIAL_SPECULAR  = Id{ 2, "material.specular" };
+        static constexpr auto MATERIAL_SHININESS = Id{ 3, "material.shininess" };
+
+        static constexpr auto UNLIT_TEXTURE = Id{ 4, "unlitTexture" };
+
+        static constexpr auto TEXTURED_MATERIAL_DIFFUSE   = Id{ 5, "texturedMaterial.diffuse" };
+        static constexpr auto TEXTURED_MATERIAL_SPECULAR  = Id{ 6, "texturedMaterial.specular" };
+        static constexpr auto TEXTURED_MATERIAL_SHININESS = Id{ 7, "texturedMaterial.shininess" };
 
-        static constexpr auto UNLIT_TEXTURE = "unlitTexture";
+    private:
+		static constexpr auto MODEL      = Id{ 8, "model" };
+		static constexpr auto NORMAL_MAT = Id{ 9, "normalMat" };
 
-        static constexpr auto TEXTURED_MATERIAL_DIFFUSE   = "texturedMaterial.diffuse";
-        static constexpr auto TEXTURED_MATERIAL_SPECULAR  = "texturedMaterial.specular";
-        static constexpr auto TEXTURED_MATERIAL_SHININESS = "texturedMaterial.shininess";
+        static constexpr auto COUNT = 10;
 
-    private:
-		static constexpr auto MODEL      = "model";
-		static constexpr auto VIEW       = "view";
-		static constexpr auto PROJECTION = "projection";
-		static constexpr auto NORMAL_MAT = "normalMat";
-
-		static constexpr auto DIRECTIONAL_LIGHT_DIRECTION = "directionalLight.direction";
-		static constexpr auto DIRECTIONAL_LIGHT_AMBIENT   = "directionalLight.ambient";
-		static constexpr auto DIRECTIONAL_LIGHT_DIFFUSE   = "directionalLight.diffuse";
-		static constexpr auto DIRECTIONAL_LIGHT_SPECULAR  = "directionalLight.specular";
-
-		static constexpr auto POINT_LIGHT_POSITION  = "pointLight.position";
-		static constexpr auto POINT_LIGHT_AMBIENT   = "pointLight.ambient";
-		static constexpr auto POINT_LIGHT_DIFFUSE   = "pointLight.diffuse";
-		static constexpr auto POINT_LIGHT_SPECULAR  = "pointLight.specular";
-		static constexpr auto POINT_LIGHT_CONSTANT  = "pointLight.constant";
-		static constexpr auto POINT_LIGHT_LINEAR    = "pointLight.linear";
-		static constexpr auto POINT_LIGHT_QUADRATIC = "pointLight.quadratic";
-
-		static constexpr auto ENABLED_DIRECTIONAL_LIGHT = "enabledDirectionalLight";
-		static constexpr auto ENABLED_POINT_LIGHT       = "enabledPointLight";
-        static constexpr auto ENABLED_TEXTURED_MATERIAL = "enabledTexturedMaterial";
-        static constexpr auto ENABLED_UNLIT_TEXTURE     = "enabledUnlitTexture";
+        static constexpr std::array<Id, COUNT> ALL{
+            MATERIAL_AMBIENT, MATERIAL_DIFFUSE, MATERIAL_SPECULAR, MATERIAL_SHININESS,
+            UNLIT_TEXTURE,
+            TEXTURED_MATERIAL_DIFFUSE, TEXTURED_MATERIAL_SPECULAR, TEXTURED_MATERIAL_SHININESS,
+            MODEL, NORMAL_MAT,
+        };
 
         friend class Renderer;
+        friend class Shader;
 	};
 
 	class Builder {
 	public:
 		explicit Builder(const Model model) : _model{ model } {}
 
+		Builder& feature(Feature feature);
+
+		/**
+		 * Builds a new Shader instance. Instances of the same model and features share a single linked program from
+		 * the Engine's program cache, only the first one of them pays for compiling and linking.
+		 * @param engine - the Engine owning the program cache.
+		 * @return a Shader with its own material parameters and texture bindings.
+		 */
 		Shader* build(Engine& engine) const;
 
 	private:
 		const Model _model;
 
+		unsigned _features{ 0 };
+
 		[[nodiscard]] std::pair<std::string, std::string> resolveShaderUri() const;
 
-		static GLuint createProgram(
+		[[nodiscard]] GLuint createProgram(
 			std::string_view vertexShaderUri,
-			std::string_view fragmentShaderUri
-		);
+			std::string_view fragmentShaderUri,
+			Engine& engine
+		) const;
 
-		static std::vector<char> readFile(std::string_view uri);
+		[[nodiscard]] std::string readSource(std::string_view uri) const;
 
 		static void validateCompilation(GLuint shader);
+
+		static GLuint loadProgramBinary(const std::string& path, std::uint64_t key);
+
+		static void saveProgramBinary(GLuint program, const std::string& path, std::uint64_t key);
 	};
 
 	[[nodiscard]] GLuint getProgram() const;
 
 	[[nodiscard]] Model getModel() const;
 
-    [[nodiscard]] std::vector<std::pair<GLenum, GLuint>> getTextureBindings() const;
+	[[nodiscard]] bool hasFeature(Feature feature) const;
+
+    [[nodiscard]] const std::vector<std::pair<GLenum, GLuint>>& getTextureBindings() const;
 
 	void use() const;
 
-	void setUniform(std::string_view name, bool value) const;
-	void setUniform(std::string_view name, const float* matrix) const;
-	void setUniform(std::string_view name, float value) const;
-	void setUniform(std::string_view name, float x, float y, float z) const;
+	[[nodiscard]] GLint getLocation(std::string_view name) const;
+
+	// Material values are kept by this instance and uploaded by the Renderer every time it switches to this Shader,
+	// so they can be set at any time and don't affect other instances sharing the same program.
+	void setUniform(Uniform::Id uniform, bool value);
+	void setUniform(Uniform::Id uniform, const float* matrix);
+	void setUniform(Uniform::Id uniform, float value);
+	void setUniform(Uniform::Id uniform, float x, float y, float z);
+    void setUniform(Uniform::Id uniform, const Texture& texture);
+
+	void setUniform(std::string_view name, bool value);
+	void setUniform(std::string_view name, const float* matrix);
+	void setUniform(std::string_view name, float value);
+	void setUniform(std::string_view name, float x, float y, float z);
     void setUniform(std::string_view name, const Texture& texture);
 
 private:
-	explicit Shader(const GLuint program, const Model model)
-	: _program{ program }, _model{ model } {}
+	// A linked program along with its introspected uniform locations, shared by all Shaders of the same model and
+	// features. The Engine keeps it alive as long as one of these Shaders is.
+	struct Program {
+		GLuint id{ 0 };
+		// Locations of every active uniform in the program, introspected once at link time
+		std::map<std::string, GLint, std::less<>> locations{};
+		// Locations of the Uniform::Id handles, indexed by Uniform::Id::index
+		std::array<GLint, Uniform::COUNT> handles{};
+		int users{ 0 };
+
+		void resolveLocations();
+	};
+
+	struct Parameter {
+		enum class Type { INT, FLOAT, FLOAT3, MAT4 };
+		GLint location;
+		Type type;
+		std::array<float, 16> value;
+	};
 
-	const GLuint _program;
+	Shader(Program* program, Model model, unsigned features);
+
+	Program* const _program;
 
 	const Model _model;
 
+	const unsigned _features;
+
+	std::vector<Parameter> _parameters{};
+
     std::vector<std::pair<GLenum, GLuint>> _textureBindings{};
+
+	void setParameter(GLint location, Parameter::Type type, const float* value, std::size_t count);
+
+	void setTextureUnit(GLint location, const Texture& texture);
+
+	// Uploads the material parameters of this instance to the (bound) shared program
+	void applyParameters() const;
+
+	// Per-draw uniforms go straight to the bound program
+	void uploadUniform(Uniform::Id uniform, const float* matrix) const;
+
+	friend class Engine;
+	friend class Renderer;
 };
\ No newline at end of file
@@ -0,0 +1,131 @@
+// Copyright (c) 2023. Minh Nguyen
+// All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "EntityManager.h"
+
+/**
+ * Components of type T keyed by entity. The components are packed into one contiguous array which iteration walks in
+ * order, while a sparse array indexed by the entity's index finds any of them in constant time. A handle whose index
+ * has since been recycled for another entity finds nothing.
+ */
+template <typename T>
+class SparseSet {
+public:
+	[[nodiscard]] bool contains(const Entity entity) const {
+		return find(entity) != NONE;
+	}
+
+	[[nodiscard]] T& get(const Entity entity) {
+		return const_cast<T&>(std::as_const(*this).get(entity));
+	}
+
+	[[nodiscard]] const T& get(const Entity entity) const {
+		const auto position = find(entity);
+		if (position == NONE) {
+			throw std::out_of_range("[SparseSet] \t- The entity has no such component.");
+		}
+		return _components[position];
+	}
+
+	// The entity's component, nullptr if it has none
+	[[nodiscard]] T* tryGet(const Entity entity) {
+		const auto position = find(entity);
+		return position == NONE ? nullptr : &_components[position];
+	}
+
+	[[nodiscard]] const T* tryGet(const Entity entity) const {
+		const auto position = find(entity);
+		return position == NONE ? nullptr : &_components[position];
+	}
+
+	/**
+	 * Gives the entity a component built from args, replacing the one it has or the one left over by a previous
+	 * entity of the same index.
+	 * @return The new component.
+	 */
+	template <typename... Args>
+	T& emplace(const Entity entity, Args&&... args) {
+		const auto index = EntityManager::getIndex(entity);
+		if (index >= _sparse.size()) {
+			_sparse.resize(index + 1, NONE);
+		}
+		if (_sparse[index] != NONE) {
+			_entities[_sparse[index]] = entity;
+			_components[_sparse[index]] = T{ std::forward<Args>(args)... };
+			return _components[_sparse[index]];
+		}
+		_sparse[index] = static_cast<std::uint32_t>(_entities.size());
+		_entities.push_back(entity);
+		_components.push_back(T{ std::forward<Args>(args)... });
+		return _components.back();
+	}
+
+	// Removes the entity's component by moving the last one into its place, which keeps the array packed
+	void erase(const Entity entity) {
+		const auto position = find(entity);
+		if (position == NONE) {
+			return;
+		}
+		const auto last = static_cast<std::uint32_t>(_entities.size() - 1);
+		if (position != last) {
+			_entities[position] = _entities[last];
+			_components[position] = std::move(_components[last]);
+			_sparse[EntityManager::getIndex(_entities[position])] = position;
+		}
+		_sparse[EntityManager::getIndex(entity)] = NONE;
+		_entities.pop_back();
+		_components.pop_back();
+	}
+
+	void clear() {
+		_sparse.clear();
+		_entities.clear();
+		_components.clear();
+	}
+
+	[[nodiscard]] std::size_t size() const {
+		return _entities.size();
+	}
+
+	[[nodiscard]] bool empty() const {
+		return _entities.empty();
+	}
+
+	// The entities with a component, in the same order as getComponents()
+	[[nodiscard]] std::span<const Entity> getEntities() const {
+		return _entities;
+	}
+
+	[[nodiscard]] std::span<T> getComponents() {
+		return _components;
+	}
+
+	[[nodiscard]] std::span<const T> getComponents() const {
+		return _components;
+	}
+
+private:
+	static constexpr auto NONE = std::uint32_t{ 0xFFFFFFFF };
+
+	std::vector<std::uint32_t> _sparse{};
+
+	std::vector<Entity> _entities{};
+
+	std::vector<T> _components{};
+
+	[[nodiscard]] std::uint32_t find(const Entity entity) const {
+		const auto index = EntityManager::getIndex(entity);
+		if (index >= _sparse.size() || _sparse[index] == NONE || _entities[_sparse[index]] != entity) {
+			return NONE;
+		}
+		return _sparse[index];
+	}
+};
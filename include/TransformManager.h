@@ -3,17 +3,48 @@
 
 #pragma once
 
+#include <cstdint>
 #include <glm/gtc/matrix_transform.hpp>
-#include <unordered_map>
+#include <span>
+#include <vector>
 
 #include "EntityManager.h"
 
 class TransformManager {
 public:
+	/**
+	 * Sets the transform of an entity relative to its parent, or to the world if it has none. The world transforms of
+	 * the entity and its descendants are brought up to date by the next updateWorldTransforms().
+	 * @param entity - the entity, given a transform component if it doesn't have one yet.
+	 * @param transform - the local transform.
+	 */
 	void setTransform(Entity entity, const glm::mat4& transform);
 
+	// The local transform of the entity, the identity if it has none
 	[[nodiscard]] glm::mat4 getTransform(Entity entity) const;
 
+	// The world transform of the entity as of the last updateWorldTransforms(), the identity if it has none
+	[[nodiscard]] glm::mat4 getWorldTransform(Entity entity) const;
+
+	/**
+	 * Attaches an entity to a parent, its local transform is relative to the parent's world transform from then on.
+	 * Either entity is given a transform component if it doesn't have one yet.
+	 * @param child - the child entity.
+	 * @param parent - the parent entity, which must not be a descendant of the child.
+	 */
+	void setParent(Entity child, Entity parent);
+
+	// Detaches the entity from its parent, its local transform becomes relative to the world
+	void clearParent(Entity entity);
+
+	[[nodiscard]] bool hasComponent(Entity entity) const;
+
+	/**
+	 * Recomputes the world transforms of the entities whose local transform or parent changed, and of their
+	 * descendants, in a single pass from the roots down. Untouched subtrees cost a flag check per entity.
+	 */
+	void updateWorldTransforms();
+
 private:
 	TransformManager() = default;
 
@@ -21,8 +52,35 @@ private:
 
 	static TransformManager* getInstance();
 
-	std::unordered_map<Entity, glm::mat4> _transforms{};
+	static constexpr auto NONE = -1;
+
+	// Entity index to index into the arrays below, NONE for entities without a transform
+	std::vector<int> _indices{};
+
+	// One element per transform component, all addressed by the same index
+	std::vector<Entity> _entities{};
+	std::vector<glm::mat4> _locals{};
+	std::vector<glm::mat4> _worlds{};
+	std::vector<int> _parents{};
+	std::vector<std::uint8_t> _dirty{};
+
+	// Indices ordered so that parents come before their children, rebuilt when the hierarchy changes
+	std::vector<int> _order{};
+
+	bool _hierarchyChanged{ false };
+
+	[[nodiscard]] int findIndex(Entity entity) const;
+
+	int obtainIndex(Entity entity);
+
+	// Removes the entity's transform, its children become roots
+	void remove(Entity entity);
+
+	// Removes the transforms of all the entities, compacting the arrays once
+	void remove(std::span<const Entity> entities);
+
+	void sortHierarchy();
 
 	friend class Engine;
 	friend class Renderer;
-};
\ No newline at end of file
+};
@@ -3,7 +3,12 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <glad/glad.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <set>
 #include <vector>
 
@@ -23,6 +28,17 @@ public:
 		COLOR	 = 2,
 		UV0		 = 3,
 		UV1		 = 4,
+		// Per-instance attributes of instanced renderables, the transform takes up locations 5 to 8
+		INSTANCE_TRANSFORM = 5,
+		INSTANCE_COLOR	   = 9,
+	};
+
+	enum class Usage {
+		// Filled once or occasionally, every upload goes through glBufferSubData
+		STATIC,
+		// Rewritten as often as every frame, uploads are copied into a persistently mapped ring of regions so that
+		// the CPU never waits on a region the GPU may still be reading from
+		STREAM,
 	};
 
 	enum class AttributeType {
@@ -31,6 +47,17 @@ public:
 		FLOAT3,
 		FLOAT4,
 		UINT,
+		// Half floats, for values that don't need the range or precision of a float
+		HALF2,
+		HALF4,
+		// 16-bit signed integers, mapped onto [-1, 1] when normalized
+		SHORT2,
+		SHORT4,
+		// Three signed 10-bit components and a 2-bit one packed into 32 bits, mapped onto [-1, 1] when normalized
+		INT_2_10_10_10_REV,
+		// A unit vector folded onto an octahedron and stored as two normalized 16-bit integers. It is set from three
+		// components and decoded in the vertex shader, see Shader::Feature::OCTAHEDRAL_NORMALS.
+		OCTAHEDRAL,
 	};
 
 private:
@@ -42,6 +69,8 @@ private:
 	};
 
 public:
+	class Packer;
+
 	class Builder {
 	public:
 		explicit Builder(int bufferCount);
@@ -56,16 +85,90 @@ public:
 			int byteStride
 		);
 
+		/**
+		 * Appends an attribute to the interleaved vertex of the buffer at index. Attributes appended this way are laid
+		 * out one after the other in the order of the calls, their stride is the size of the whole vertex.
+		 * @param index - the index of the buffer.
+		 * @param attr - the attribute.
+		 * @param type - the type of the attribute, which determines its size.
+		 */
+		Builder& attribute(int index, VertexAttribute attr, AttributeType type);
+
 		Builder& normalized(VertexAttribute attr);
 
+		Builder& usage(Usage usage);
+
 		VertexBuffer* build(Engine& engine);
 
 	private:
 		int _vertexCount{ 0 };
+
+		Usage _usage{ Usage::STATIC };
 		
 		std::vector<std::set<AttributeInfo>> _layout;
 
+		// Size of the interleaved vertex of each buffer, as far as attributes have been appended to it
+		std::vector<int> _packedSizes;
+
 		std::set<VertexAttribute> _normAttrs{};
+
+		friend class VertexBuffer::Packer;
+	};
+
+	/**
+	 * Packs vertices on the CPU into the layout of one buffer declared by a Builder, converting each value to the type
+	 * of its attribute. The result is uploaded as is with setBufferAt, so a drawable fills a single interleaved buffer
+	 * instead of one std::vector per attribute.
+	 */
+	class Packer {
+	public:
+		Packer(const Builder& builder, int index);
+
+		// Starts a new vertex, its attributes are all zero until set
+		Packer& vertex();
+
+		// Sets an attribute of the current vertex, components beyond those of the attribute's type are ignored
+		Packer& set(VertexAttribute attr, float x, float y = 0.0f, float z = 0.0f, float w = 0.0f);
+		Packer& set(VertexAttribute attr, const glm::vec2& value);
+		Packer& set(VertexAttribute attr, const glm::vec3& value);
+		Packer& set(VertexAttribute attr, const glm::vec4& value);
+
+		/**
+		 * Sets an attribute for a run of vertices at once, adding vertices as needed.
+		 * @param attr - the attribute.
+		 * @param values - as many floats per vertex as the attribute's type has components, starting at the first vertex.
+		 */
+		Packer& set(VertexAttribute attr, const std::vector<float>& values);
+
+		[[nodiscard]] int getVertexCount() const;
+
+		[[nodiscard]] int getStride() const;
+
+		[[nodiscard]] const void* data() const;
+
+		// Where the attribute of the first vertex lives, the following ones are getStride() bytes apart
+		[[nodiscard]] const void* data(VertexAttribute attr) const;
+
+	private:
+		struct Slot {
+			VertexAttribute attr;
+			AttributeType type;
+			int byteOffset;
+			bool normalized;
+		};
+
+		std::vector<Slot> _slots{};
+
+		int _stride{ 0 };
+
+		int _vertexCount{ 0 };
+
+		std::vector<std::byte> _data{};
+
+		[[nodiscard]] const Slot& findSlot(VertexAttribute attr) const;
+
+		// Converts the values of count consecutive vertices to the slot's type, tightly packed into target
+		static void encode(const Slot& slot, const float* values, int count, std::byte* target);
 	};
 
 	[[nodiscard]] GLuint getNativeObject() const;
@@ -74,7 +177,15 @@ public:
 
 	[[nodiscard]] int getBufferCount() const;
 
-	void setBufferAt(int index, const void* data) const;
+	[[nodiscard]] Usage getUsage() const;
+
+	/**
+	 * Uploads the vertex data of the buffer at index, sized after the vertex count and the buffer's layout. Streaming
+	 * buffers write to the next region of their ring, which the renderer picks up from then on.
+	 * @param index - the index of the buffer as declared in the Builder.
+	 * @param data - the vertex data.
+	 */
+	void setBufferAt(int index, const void* data);
 
 	friend bool operator<(const AttributeInfo& lhs, const AttributeInfo& rhs) {
 		return lhs.attr < rhs.attr;
@@ -85,7 +196,8 @@ private:
 		GLuint* bufferObjects,
 		int vertexCount,
 		std::vector<std::set<AttributeInfo>>&& layout,
-		std::set<VertexAttribute>&& normAttrs
+		std::set<VertexAttribute>&& normAttrs,
+		Usage usage
 	) noexcept;
 
 	GLuint* const _bufferObjects;
@@ -96,8 +208,41 @@ private:
 
 	const std::set<VertexAttribute> _normAttrs;
 
-	[[nodiscard]] int computeVertexByteSize(int bufferIndex) const;
+	const Usage _usage;
+
+	static constexpr auto REGION_COUNT = 3;
+
+	// The ring of a streaming buffer, each region holds a full copy of the buffer's vertex data
+	struct Stream {
+		std::byte* mapped{ nullptr };
+		int region{ 0 };
+		bool written{ false };
+		// Signaled once the GPU is done with the commands issued while the region was current
+		std::array<GLsync, REGION_COUNT> fences{};
+	};
+
+	// One per buffer for streaming vertex buffers, empty otherwise
+	std::vector<Stream> _streams{};
+
+	void allocate();
+
+	[[nodiscard]] GLintptr getRegionOffset(int bufferIndex) const;
+
+	// Points the attributes of the bound VAO sourced from streaming buffers at their current regions
+	void bindStreams() const;
+
+	// The number of bytes the buffer at bufferIndex spans, whatever the layout of its attributes
+	[[nodiscard]] GLsizeiptr computeBufferByteSize(int bufferIndex) const;
+
+	static int resolveByteSize(AttributeType type);
+
+	// The number of floats it takes to set an attribute of the type, not necessarily the number it is stored with
+	static int resolveComponentCount(AttributeType type);
+
+	// Whether the attribute is fetched normalized, some types are regardless of the Builder
+	static bool resolveNormalized(AttributeType type, bool requested);
 
 	friend class Engine;
 	friend class RenderableManager;
+	friend class Renderer;
 };
\ No newline at end of file
@@ -24,6 +24,9 @@ public:
 
         Builder& high(float hi);
 
+        // Generates the vertices and indices without touching OpenGL, build() uploads them
+        [[nodiscard]] Geometry generate() const;
+
         std::unique_ptr<Drawable> build(Engine& engine) override;
 
     private:
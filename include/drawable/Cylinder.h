@@ -17,6 +17,9 @@ public:
 	public:
 		Builder& segments(int segments);
 
+		// Generates the vertices and indices without touching OpenGL, build() uploads them
+		[[nodiscard]] Geometry generate() const;
+
 		std::unique_ptr<Drawable> build(Engine& engine) override;
 
 	private:
@@ -4,13 +4,17 @@
 #pragma once
 
 #include <glm/vec3.hpp>
+#include <initializer_list>
 #include <memory>
 #include <stdexcept>
 
 #include "EntityManager.h"
+#include "RenderableManager.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "VertexBuffer.h"
 
+#include "drawable/Geometry.h"
 #include "drawable/Material.h"
 
 class Drawable {
@@ -55,11 +59,37 @@ public:
         /**
          * Builds an instance of the default shader using the default values set for this Drawable's Builder. The derived
          * builders can choose to use this default shader which handles most of the shading initializations, or create a
-         * new one and initialize it on theirs own.
+         * new one and initialize it on theirs own. The program behind the shader is shared with every other Drawable
+         * using the same shader model and textures.
          * @param engine - the Engine used for this Drawable::Builder's construction.
+         * @param features - features the derived builder's geometry needs, on top of those implied by the textures.
          * @return The default Shader.
          */
-        [[nodiscard]] Shader* defaultShader(Engine& engine) const;
+        [[nodiscard]] Shader* defaultShader(Engine& engine, std::initializer_list<Shader::Feature> features = {}) const;
+
+        /**
+         * Uploads the vertices of generated geometry into a single buffer of interleaved floats, with the attributes
+         * the geometry has.
+         * @param engine - the Engine owning the vertex buffer.
+         * @param geometry - the generated geometry.
+         * @return The vertex buffer.
+         */
+        [[nodiscard]] static VertexBuffer* uploadVertices(Engine& engine, const Geometry& geometry);
+
+        /**
+         * Uploads the indices of generated geometry and sets up an element for each of its parts, all drawn with the
+         * same shader. Indices are stored in 16 bits whenever they fit.
+         * @param engine - the Engine owning the index buffer.
+         * @param geometry - the generated geometry.
+         * @param vertices - the geometry's vertices, already uploaded.
+         * @param shader - the shader of every part.
+         * @return The renderable's builder, with the geometry, shader and bounding box of every part set.
+         */
+        [[nodiscard]] static RenderableManager::Builder uploadParts(
+            Engine& engine, const Geometry& geometry, const VertexBuffer& vertices, Shader* shader);
+
+        // Uploads both the vertices and the parts of generated geometry
+        [[nodiscard]] static RenderableManager::Builder upload(Engine& engine, const Geometry& geometry, Shader* shader);
 
     private:
 		Shader::Model _shaderModel{ Shader::Model::UNLIT };
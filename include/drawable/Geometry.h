@@ -0,0 +1,44 @@
+// Copyright (c) 2023. Minh Nguyen
+// All rights reserved.
+
+#pragma once
+
+#include <vector>
+
+#include "RenderableManager.h"
+
+/**
+ * The vertices and indices of a drawable as generated on the CPU, before anything is uploaded. The builders produce it
+ * without touching OpenGL, so generation can be run and measured on its own.
+ */
+struct Geometry {
+	// Tightly packed per-vertex attributes: 3, 4, 3 and 2 floats per vertex. Attributes a drawable lacks stay empty.
+	std::vector<float> positions{};
+	std::vector<float> colors{};
+	std::vector<float> normals{};
+	std::vector<float> uvs{};
+
+	// The indices of every part, one after the other
+	std::vector<unsigned> indices{};
+
+	// A run of indices drawn by a single element
+	struct Part {
+		RenderableManager::PrimitiveType topology;
+		int count;
+		int offset;
+		// Added to the part's indices, they stay small enough for 16 bits when large surfaces are split into parts
+		int baseVertex;
+	};
+
+	std::vector<Part> parts{};
+
+	/**
+	 * Appends indices to the index list as a new part.
+	 * @param topology - how the part's indices are assembled into primitives.
+	 * @param partIndices - the part's indices, relative to baseVertex.
+	 * @param baseVertex - the vertex the part's indices are relative to.
+	 */
+	void addPart(RenderableManager::PrimitiveType topology, const std::vector<unsigned>& partIndices, int baseVertex = 0);
+
+	[[nodiscard]] int getVertexCount() const;
+};
@@ -4,8 +4,11 @@
 #pragma once
 
 #include <functional>
+#include <span>
+#include <vector>
 
 #include "Drawable.h"
+#include "RenderableManager.h"
 
 class Mesh : public Drawable {
 public:
@@ -17,8 +20,18 @@ public:
 
 	class Builder : public Drawable::Builder {
 	public:
+		// Evaluates the surface at zs[k] = f(xs[k], ys[k]) for whole runs of points at once
+		using BatchFunction = std::function<void(std::span<const float> xs, std::span<const float> ys, std::span<float> zs)>;
+
 		explicit Builder(std::function<float(float, float)> func) : _func{ std::move(func) } {}
 
+		/**
+		 * Registers a batch version of the surface's function, used instead of the one given at construction when the
+		 * surface is sampled. Either may be called from several threads at once.
+		 * @param func - the batch function, it must agree with the one given at construction.
+		 */
+		Builder& batchFunction(BatchFunction func);
+
 		Builder& halfExtentX(float extent);
 		Builder& halfExtentY(float extent);
 		Builder& halfExtent(float extent);
@@ -27,10 +40,14 @@ public:
 		Builder& segmentsY(int segments);
 		Builder& segments(int segments);
 
+		// Generates the vertices and indices without touching OpenGL, build() uploads them
+		[[nodiscard]] Geometry generate() const;
+
 		std::unique_ptr<Drawable> build(Engine& engine) override;
 
     protected:
 		const std::function<float(float, float)> _func;
+		BatchFunction _batchFunc{ nullptr };
 		float _halfExtentX{ 1.0f };
 		float _halfExtentY{ 1.0f };
 		int _segmentsX{ 40 };
@@ -38,6 +55,25 @@ public:
 
 		static constexpr auto MIN_SEGMENTS = 1;
 		static constexpr auto MIN_EXTENT = 0.1f;
+
+		/**
+		 * Lays the grid of vertices out as one triangle strip per column pair, separated by the primitive restart
+		 * index. The strips are grouped into as few bands as 16-bit indices allow, one part each, so a surface is
+		 * drawn by a single element unless it has more than 65535 vertices.
+		 * @param geometry - the geometry the bands are added to as parts, its vertices laid out column by column.
+		 */
+		void addStrips(Geometry& geometry) const;
+
+		/**
+		 * Samples the surface once at every vertex of the grid and one step beyond each edge, which leaves the
+		 * neighbours finite differences need for every vertex. Columns are sampled in parallel.
+		 * @return The heights, column by column, getPaddedColumnSize() per column.
+		 */
+		[[nodiscard]] std::vector<float> sampleHeights() const;
+
+		// The number of heights per column returned by sampleHeights(), the vertex at i, j is at
+		// (i + 1) * getPaddedColumnSize() + j + 1
+		[[nodiscard]] int getPaddedColumnSize() const;
 	};
 
 private:
@@ -15,6 +15,9 @@ public:
 
 	class Builder final : public Drawable::Builder {
 	public:
+		// Generates the vertices and indices without touching OpenGL, build() uploads them
+		[[nodiscard]] Geometry generate() const;
+
 		std::unique_ptr<Drawable> build(Engine& engine) override;
 	};
 
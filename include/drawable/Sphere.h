@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <array>
+#include <optional>
 #include <vector>
 
 #include "Drawable.h"
@@ -21,6 +23,9 @@ public:
 
 		GeographicBuilder& latitudes(int amount);
 
+		// Generates the vertices and indices without touching OpenGL, build() uploads them
+		[[nodiscard]] Geometry generate() const;
+
 		std::unique_ptr<Drawable> build(Engine& engine) override;
 
 	private:
@@ -41,6 +46,9 @@ public:
 
         SubdivisionBuilder& uniformColor(float r, float g, float b);
 
+		// Generates the vertices and indices without touching OpenGL, build() uploads them
+		[[nodiscard]] Geometry generate() const;
+
 		std::unique_ptr<Drawable> build(Engine& engine) override;
 
 	protected:
@@ -53,16 +61,17 @@ public:
 
 		Polyhedron _polyhedron{ Polyhedron::TETRAHEDRON };
 
-		float* _uniformColor{ nullptr };
+		std::optional<std::array<float, 3>> _uniformColor{};
 
 		[[nodiscard]] std::vector<glm::vec3> getFaces() const;
 
-		[[nodiscard]] std::vector<float> subdivide(
-			const glm::vec3& p0, 
-			const glm::vec3& p1, 
-			const glm::vec3& p2,
-			int depth
-		) const;
+		/**
+		 * Splits every triangle into four, _depth times over, pushing the edge midpoints out to the sphere. Each
+		 * midpoint is created once and shared by the triangles on both sides of its edge.
+		 * @param positions - the vertices, the midpoints are appended to them.
+		 * @param triangles - three indices per triangle, replaced by those of the subdivided triangles.
+		 */
+		void subdivide(std::vector<glm::vec3>& positions, std::vector<unsigned>& triangles) const;
 	};
 
 private:
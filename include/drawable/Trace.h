@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <glm/mat4x4.hpp>
+
 #include "Drawable.h"
 
 class Trace : public Drawable {
@@ -20,7 +22,13 @@ public:
         Builder& normal(const glm::vec3& normal);
         Builder& color(float r, float g, float b);
         Builder& size(float size);
+        Builder& capacity(int capacity);
 
+        /**
+         * Builds an instanced quad holding the trace described by this builder as its first instance. More traces
+         * can be appended to it with RenderableManager::addInstance and Trace::getInstanceTransform, they are all
+         * drawn with a single draw call.
+         */
         std::unique_ptr<Drawable> build(Engine& engine) override;
 
     private:
@@ -29,8 +37,20 @@ public:
         glm::vec3 _normal{ 0.0f, 0.0f, 1.0f };
         glm::vec3 _color{ 1.0f, 1.0f, 1.0f };
         float _size{ 0.15f };
+        int _capacity{ 64 };
     };
 
+    /**
+     * Computes the transform that maps the unit quad of a trace onto the trace with the given placement.
+     * @param position - the center of the trace.
+     * @param direction - the direction the trace is facing.
+     * @param normal - the normal of the surface the trace lays on.
+     * @param size - the side length of the trace.
+     * @return the instance transform to pass to RenderableManager::addInstance.
+     */
+    static glm::mat4 getInstanceTransform(
+        const glm::vec3& position, const glm::vec3& direction, const glm::vec3& normal, float size);
+
 private:
     Trace(const Entity entity, Shader* const shader) : Drawable(entity, shader) {}
 };
\ No newline at end of file
@@ -57,8 +57,15 @@ private:
     const glm::vec3 _traceColor;
     const glm::vec3 _markColor;
 
-    std::vector<std::unique_ptr<Drawable>> _currentTraces{};
+    // Every mark and trace step is an instance of one of these, created along with the first placement
+    std::unique_ptr<Drawable> _marks{};
+    std::unique_ptr<Drawable> _traces{};
 
     float _currentX{ 0.0f };
     float _currentY{ 0.0f };
+
+    void place(
+        std::unique_ptr<Drawable>& batch, const glm::vec3& position, const glm::vec3& direction,
+        const glm::vec3& color, Scene& scene, Engine& engine
+    ) const;
 };
@@ -75,10 +75,18 @@ private:
     const phong::Material _traceMaterial;
     const phong::Material _markMaterial;
 
-    std::vector<std::unique_ptr<Drawable>> _currentTraces{};
+    // Every mark and trace step is an instance of one of these, created along with the first placement
+    std::unique_ptr<Drawable> _marks{};
+    std::unique_ptr<Drawable> _traces{};
 
     float _currentX{ 0.0f };
     float _currentY{ 0.0f };
 
     [[nodiscard]] glm::vec3 getNormalAt(float x, float y) const;
+
+    void place(
+        std::unique_ptr<Drawable>& batch, const glm::vec3& position, const glm::vec3& direction,
+        const glm::vec3& normal, const glm::vec3& color, const phong::Material& material,
+        Scene& scene, Engine& engine
+    ) const;
 };
@@ -3,13 +3,26 @@
 
 #pragma once
 
+#include <glad/glad.h>
+#include <array>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 class MediaExporter {
 public:
+    ~MediaExporter();
+    MediaExporter(const MediaExporter&) = delete;
+    MediaExporter(MediaExporter&&) noexcept = delete;
+    MediaExporter& operator=(const MediaExporter&) = delete;
+    MediaExporter& operator=(MediaExporter&&) noexcept = delete;
+
     class Builder {
     public:
         Builder& folderPath(std::string_view path);
@@ -19,10 +32,77 @@ public:
         std::string _folderPath{ "./capture/" };
     };
 
-    void exportImage(std::string_view name, const void* data, int width, int height) const;
+    /**
+     * Writes an image to a PNG file on the encoding thread, the call itself only copies the pixels.
+     * @param data Tightly packed RGBA rows, top row first
+     */
+    void exportImage(std::string_view name, const void* data, int width, int height);
+
+    /**
+     * Starts reading back a region of the bound read framebuffer into a pixel buffer without waiting for the GPU.
+     * The image is handed to the encoding thread by a later call to poll() or flush(), once the transfer is done.
+     * Must be called on the thread owning the OpenGL context.
+     */
+    void capture(std::string_view name, int x, int y, int width, int height);
+
+    /**
+     * Hands the captures the GPU has finished transferring over to the encoding thread. Meant to be called once
+     * per frame, it never blocks.
+     */
+    void poll();
+
+    /**
+     * Waits for every pending capture to be transferred and handed over to the encoding thread.
+     */
+    void flush();
 
 private:
-    explicit MediaExporter(std::filesystem::path&& dirPath) noexcept : _dirPath{ dirPath } {}
+    explicit MediaExporter(std::filesystem::path&& dirPath);
 
     const std::filesystem::path _dirPath;
+
+    // A pixel buffer and the fence signalled once the read into it is complete
+    struct Readback {
+        GLuint buffer{ 0 };
+        GLsizeiptr capacity{ 0 };
+        GLsync fence{ nullptr };
+        std::string name{};
+        int width{ 0 };
+        int height{ 0 };
+    };
+
+    // Enough for the GPU to stay a couple of frames behind without any capture waiting
+    static constexpr auto READBACK_COUNT = 3;
+
+    std::array<Readback, READBACK_COUNT> _readbacks{};
+
+    // The slot the next capture goes to, slots complete in the order they were issued
+    int _nextReadback{ 0 };
+
+    // Maps a finished readback, flips it right side up and queues it for encoding
+    void complete(Readback& readback, bool wait);
+
+    struct Job {
+        std::string name;
+        std::vector<unsigned char> pixels;
+        int width;
+        int height;
+    };
+
+    std::mutex _mutex{};
+
+    std::condition_variable _available{};
+
+    std::deque<Job> _jobs{};
+
+    bool _stopping{ false };
+
+    // Encodes queued images one after the other, declared last so it starts after everything it uses
+    std::jthread _encoder;
+
+    void enqueue(Job&& job);
+
+    void encode();
+
+    void write(const Job& job) const;
 };
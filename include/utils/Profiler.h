@@ -0,0 +1,165 @@
+// Copyright (c) 2023. Minh Nguyen
+// All rights reserved.
+
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+/**
+ * Records where the time of each frame goes, as named CPU scopes and GPU scopes timed with GL_TIME_ELAPSED queries,
+ * along with the renderer's counters. Finished frames land in a fixed ring that can be read from any thread without
+ * blocking the render thread, and dumped in the Chrome trace-event format (chrome://tracing, Perfetto).
+ *
+ * Everything but snapshot() and the trace writers must be called on the thread owning the OpenGL context.
+ */
+class Profiler {
+public:
+    Profiler(const Profiler&) = delete;
+    Profiler(Profiler&&) noexcept = delete;
+    Profiler& operator=(const Profiler&) = delete;
+    Profiler& operator=(Profiler&&) noexcept = delete;
+
+    static Profiler* get();
+
+    // Scopes opened while disabled record nothing and cost next to nothing
+    void setEnabled(bool enabled);
+
+    [[nodiscard]] bool isEnabled() const;
+
+    void beginFrame();
+
+    void endFrame();
+
+    /**
+     * Returns the position of the next view rendered within the current frame, used to tell views apart in the trace.
+     */
+    int nextView();
+
+    struct Counters {
+        int drawCalls{ 0 };
+        int stateChanges{ 0 };
+        std::int64_t triangles{ 0 };
+    };
+
+    // Adds to the counters of the current frame
+    void count(const Counters& counters);
+
+    // Measures the CPU time between its construction and destruction, the name must outlive the profiler
+    class Scope {
+    public:
+        explicit Scope(const char* name, int view = -1);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        int _event{ -1 };
+    };
+
+    /**
+     * Measures the GPU time of the commands issued between its construction and destruction. GL_TIME_ELAPSED queries
+     * can't overlap, a GPU scope opened inside another one is ignored.
+     */
+    class GpuScope {
+    public:
+        explicit GpuScope(const char* name, int view = -1);
+        ~GpuScope();
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+    private:
+        bool _active{ false };
+    };
+
+    struct Event {
+        const char* name{ nullptr };
+        // The view the event belongs to, -1 for none
+        int view{ -1 };
+        // Since the profiler started, GPU events are placed at the time their commands were issued
+        std::int64_t startNanos{ 0 };
+        std::int64_t durationNanos{ 0 };
+        bool gpu{ false };
+    };
+
+    static constexpr auto MAX_EVENTS = 64;
+
+    struct Frame {
+        std::uint64_t index{ 0 };
+        std::int64_t startNanos{ 0 };
+        std::int64_t durationNanos{ 0 };
+        Counters counters{};
+        int eventCount{ 0 };
+        std::array<Event, MAX_EVENTS> events{};
+    };
+
+    /**
+     * Copies the finished frames still held by the ring, oldest first. Safe to call from any thread.
+     */
+    [[nodiscard]] std::vector<Frame> snapshot() const;
+
+    void writeChromeTrace(std::ostream& stream) const;
+
+    void writeChromeTrace(const std::filesystem::path& path) const;
+
+    // Deletes the GL queries, must be called before the OpenGL context goes away
+    void releaseQueries();
+
+private:
+    Profiler();
+
+    [[nodiscard]] std::int64_t now() const;
+
+    int pushEvent(const char* name, int view, bool gpu);
+
+    bool _enabled{ false };
+
+    bool _inFrame{ false };
+
+    std::uint64_t _frameIndex{ 0 };
+
+    int _viewCount{ 0 };
+
+    Frame _current{};
+
+    // GPU results arrive a few frames late, frames wait here until their queries can be read without stalling
+    static constexpr auto FRAME_LATENCY = 4;
+
+    struct PendingFrame {
+        Frame frame{};
+        bool waiting{ false };
+        // Query objects owned by this slot, reused every FRAME_LATENCY frames
+        std::vector<GLuint> queries{};
+        // The event each used query times
+        std::vector<std::pair<int, GLuint>> timings{};
+    };
+
+    std::array<PendingFrame, FRAME_LATENCY> _pending{};
+
+    // The event of the GPU scope currently open, -1 if none
+    int _openGpuEvent{ -1 };
+
+    void resolve(PendingFrame& pending);
+
+    // A sequence lock per slot: odd while the render thread writes the slot, readers retry or skip torn copies
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{ 0 };
+        Frame frame{};
+    };
+
+    static constexpr auto RING_CAPACITY = 256;
+
+    std::unique_ptr<std::array<Slot, RING_CAPACITY>> _ring;
+
+    // The number of frames published to the ring so far
+    std::atomic<std::uint64_t> _published{ 0 };
+
+    void publish(const Frame& frame);
+
+    inline static Profiler* _instance{ nullptr };
+};
@@ -13,6 +13,16 @@ glm::mat4 getPlanetTransform(
     const glm::vec3& orbitCenter = glm::vec3{ 0.0f, 0.0f, 0.0f }
 );
 
+/**
+ * The transform of a planet relative to its orbit, which is getPlanetTransform() without the orbit's own placement.
+ * Set it on a planet parented to an entity holding getOrbitTransform() through TransformManager::setParent, and a moon
+ * orbiting that planet only needs its own local transform under an entity following the planet.
+ */
+glm::mat4 getPlanetLocalTransform(
+    float revolveAngle, float rotateAngle, float tiltingAngle, float planetRadius,
+    const std::function<float(float)>& orbitX, const std::function<float(float)>& orbitY
+);
+
 glm::mat4 getOrbitTransform(
     const glm::vec3& orbitOrientation = glm::vec3{ 0.0f, 0.0f, 1.0f },
     const glm::vec3& orbitCenter = glm::vec3{ 0.0f, 0.0f, 0.0f }
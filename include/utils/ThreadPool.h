@@ -0,0 +1,50 @@
+// Copyright (c) 2023. Minh Nguyen
+// All rights reserved.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) noexcept = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+    static ThreadPool* get();
+
+    /**
+     * Splits [begin, end) into contiguous ranges and runs the task on each of them, the calling thread included. Returns
+     * once every range is done, rethrowing the first exception a task threw if any.
+     * @param begin - the first index.
+     * @param end - one past the last index.
+     * @param task - called with the bounds of a range, concurrently with the other ranges.
+     */
+    void parallelFor(int begin, int end, const std::function<void(int, int)>& task);
+
+    [[nodiscard]] int getThreadCount() const;
+
+private:
+    explicit ThreadPool(unsigned threadCount);
+
+    std::vector<std::jthread> _workers{};
+
+    std::mutex _mutex{};
+
+    std::condition_variable _available{};
+
+    std::queue<std::function<void()>> _tasks{};
+
+    bool _stopping{ false };
+
+    void work();
+
+    inline static ThreadPool* _instance{ nullptr };
+};
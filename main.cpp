@@ -1,9 +1,14 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <charconv>
+#include <chrono>
 #include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <iostream>
+#include <span>
+#include <string_view>
 
 #include "Context.h"
 #include "Engine.h"
@@ -22,6 +27,7 @@
 #include "utils/DescentIterator.h"
 #include "utils/DescentTracer.h"
 #include "utils/MediaExporter.h"
+#include "utils/Profiler.h"
 #include "utils/TextureLoader.h"
 
 glm::mat4 getBallTransform(
@@ -35,11 +41,24 @@ glm::mat4 getContourBallTransform(float x, float y, float radius);
 
 static float ballAngle{ 0.0f };
 
-inline float getAuraVelocity(long deltaTimeMillis, float speed);
-
-int main() {
-    // The window context
-    auto context = Context::create("1952092");
+inline float objectiveAt(float x, float y);
+
+inline float getAuraVelocity(float deltaSeconds, float speed);
+
+int main(const int argc, char* argv[]) {
+    // The window context, or an off-screen one rendering a fixed number of frames when run as
+    // "CG2023 --headless <frames>", whose last frame gets captured
+    const auto headless = argc >= 2 && std::string_view{ argv[1] } == "--headless";
+    auto headlessFrames = 0;
+    if (headless) {
+        const auto value = std::string_view{ argc >= 3 ? argv[2] : "" };
+        const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), headlessFrames);
+        if (error != std::errc{} || end != value.data() + value.size() || headlessFrames < 1) {
+            std::cerr << "Usage: CG2023 [--headless <frames>], with at least 1 frame\n";
+            return 2;
+        }
+    }
+    auto context = headless ? Context::createHeadless(1600, 900, headlessFrames) : Context::create("1952092");
 
     // Set close on ESC press
     context->setOnPress(Context::Key::ESC, [&context] {
@@ -57,28 +76,23 @@ int main() {
         renderer->togglePolygonMode();
     });
 
-    // Capture the framebuffer on F1 press
+    // Capture the framebuffer on F1 press, once the frame has been rendered
     const auto exporter = MediaExporter::Builder()
             .folderPath("capture")
             .build();
-    context->setOnPress(Context::Key::F1, [&context, &exporter] {
-        // Acquire the framebuffer size
+    const auto capture = [&context, &exporter] {
         const auto& [w, h] = context->getFramebufferSize();
-        // Prepare a placeholder for RGBA image
-        const auto data = new unsigned char[w * h * 4];
-        // Load the content of the framebuffer
-        Renderer::readFramebufferRgba(0, 0, w, h, data);
-        // OpenGL expects the 0.0 coordinate on the y-axis to be on the bottom side of the image,
-        // but images usually have 0.0 at the top of the y-axis.
-        for (int y = 0; y < h / 2; y++) {
-            int i1 = y * w * 4;
-            int i2 = (h - y - 1) * w * 4;
-            for (int x = 0; x < w * 4; x++) {
-                std::swap(data[i1 + x], data[i2 + x]);
-            }
-        }
-        exporter->exportImage("scene", data, w, h);
-        delete[] data;
+        exporter->capture("scene", 0, 0, w, h);
+    };
+    auto captureRequested = false;
+    context->setOnPress(Context::Key::F1, [&captureRequested] {
+        captureRequested = true;
+    });
+
+    // Profile every frame and dump the most recent ones as a Chrome trace on F2 press
+    Profiler::get()->setEnabled(true);
+    context->setOnPress(Context::Key::F2, [] {
+        Profiler::get()->writeChromeTrace("capture/trace.json");
     });
 
     // Create a camera
@@ -160,8 +174,14 @@ int main() {
 
     // The objective function
     const auto objective = std::function{ [](const float x, const float y) {
-        return (x*x + y*y) / 40.0f + 2.0f * std::exp(-(std::cos(x / 2.0f) + y * y / 4.0f)) - std::cos(x / 1.5f) - std::sin(y / 1.5f);
+        return objectiveAt(x, y);
     }};
+    // The same function over whole runs of points, which saves a std::function call per point
+    const auto batchObjective = [](const std::span<const float> xs, const std::span<const float> ys, const std::span<float> zs) {
+        for (auto k = std::size_t{ 0 }; k < zs.size(); ++k) {
+            zs[k] = objectiveAt(xs[k], ys[k]);
+        }
+    };
     // Gradient with respect to x
     const auto gradientX = std::function{ [](const float x, const float y) {
         return (x / 20.0f) + std::exp(-(std::cos(x / 2.0f) + y * y / 4.0f)) * std::sin(x / 2.0f) + (std::sin(x / 1.5f) / 1.5f);
@@ -173,6 +193,7 @@ int main() {
 
     // The mesh
     const auto mesh = Mesh::Builder(objective)
+            .batchFunction(batchObjective)
             .halfExtent(halfExtent)
             .segments(100)
             .shaderModel(Shader::Model::PHONG)
@@ -207,6 +228,7 @@ int main() {
     const auto contour = Contour::Builder(objective)
             .low(-1.0f)
             .high(5.0f)
+            .batchFunction(batchObjective)
             .halfExtent(halfExtent)
             .segments(100)
             .build(*engine);
@@ -304,8 +326,16 @@ int main() {
         contourTracer->resetTo(x, y, *contourScene, *engine);
     });
 
-    // Manually descent the ball on SPACE holding
-    context->setOnLongPress(Context::Key::SPACE, [&]{
+    // Manually descent the ball on SPACE holding, one iteration per fixed step so that the ball rolls at the same pace
+    // whatever the frame rate
+    auto descending = false;
+    context->setOnLongPress(Context::Key::SPACE, [&descending]{
+        descending = true;
+    });
+    context->setFixedStep(std::chrono::nanoseconds{ 16'666'667 }, [&](auto) {
+        if (!descending) {
+            return;
+        }
         // Get the current position
         const auto [prevX, prevY] = sgd->getState();
         // Descent the ball
@@ -347,7 +377,7 @@ int main() {
 
     // Move the aura forward
     context->setOnLongPress(Context::Key::W, [&] {
-        const auto velocity = getAuraVelocity(context->getDeltaTimeMillis(), SPEED);
+        const auto velocity = getAuraVelocity(context->getDeltaSeconds(), SPEED);
         auraPos += glm::vec3{0.0f, 1.0f, 0.0f } * velocity;
         engine->getLightManager()->setPosition(pointLight, auraPos.x, auraPos.y, auraPos.z);
         const auto trans = translate(glm::mat4(1.0f), auraPos);
@@ -356,7 +386,7 @@ int main() {
 
     // Move the aura backward
     context->setOnLongPress(Context::Key::S, [&] {
-        const auto velocity = getAuraVelocity(context->getDeltaTimeMillis(), SPEED);
+        const auto velocity = getAuraVelocity(context->getDeltaSeconds(), SPEED);
         auraPos += glm::vec3{0.0f, -1.0f, 0.0f } * velocity;
         engine->getLightManager()->setPosition(pointLight, auraPos.x, auraPos.y, auraPos.z);
         const auto trans = translate(glm::mat4(1.0f), auraPos);
@@ -365,7 +395,7 @@ int main() {
 
     // Move the aura left
     context->setOnLongPress(Context::Key::A, [&] {
-        const auto velocity = getAuraVelocity(context->getDeltaTimeMillis(), SPEED);
+        const auto velocity = getAuraVelocity(context->getDeltaSeconds(), SPEED);
         auraPos += glm::vec3{-1.0f, 0.0f, 0.0f } * velocity;
         engine->getLightManager()->setPosition(pointLight, auraPos.x, auraPos.y, auraPos.z);
         const auto trans = translate(glm::mat4(1.0f), auraPos);
@@ -374,7 +404,7 @@ int main() {
 
     // Move the aura right
     context->setOnLongPress(Context::Key::D, [&] {
-        const auto velocity = getAuraVelocity(context->getDeltaTimeMillis(), SPEED);
+        const auto velocity = getAuraVelocity(context->getDeltaSeconds(), SPEED);
         auraPos += glm::vec3{1.0f, 0.0f, 0.0f} * velocity;
         engine->getLightManager()->setPosition(pointLight, auraPos.x, auraPos.y, auraPos.z);
         const auto trans = translate(glm::mat4(1.0f), auraPos);
@@ -383,7 +413,7 @@ int main() {
 
     // Move the aura up
     context->setOnLongPress(Context::Key::LCTR, [&] {
-        const auto velocity = getAuraVelocity(context->getDeltaTimeMillis(), SPEED);
+        const auto velocity = getAuraVelocity(context->getDeltaSeconds(), SPEED);
         auraPos += glm::vec3{0.0f, 0.0f, -1.0f } * velocity;
         engine->getLightManager()->setPosition(pointLight, auraPos.x, auraPos.y, auraPos.z);
         const auto trans = translate(glm::mat4(1.0f), auraPos);
@@ -392,7 +422,7 @@ int main() {
 
     // Move the aura down
     context->setOnLongPress(Context::Key::LSHF, [&] {
-        const auto velocity = getAuraVelocity(context->getDeltaTimeMillis(), SPEED);
+        const auto velocity = getAuraVelocity(context->getDeltaSeconds(), SPEED);
         auraPos += glm::vec3{0.0f, 0.0f, 1.0f } * velocity;
         engine->getLightManager()->setPosition(pointLight, auraPos.x, auraPos.y, auraPos.z);
         const auto trans = translate(glm::mat4(1.0f), auraPos);
@@ -417,25 +447,46 @@ int main() {
     contourScene->addEntity(contour->getEntity());
     contourScene->addEntity(contourBall->getEntity());
 
+    // Report how the programs built so far were obtained
+    const auto& programStatistics = engine->getProgramStatistics();
+    std::cout << "Programs: " << programStatistics.cacheHits << " loaded from cache, " << programStatistics.cacheMisses
+              << " compiled, " << programStatistics.millis << " ms\n";
+
+    // No need to render faster than most displays refresh
+    context->setFrameRateCap(144);
+
     // The render loop
     context->loop([&] {
         renderer->render(*view);
         renderer->render(*contourView);
+
+        if (captureRequested) {
+            capture();
+            captureRequested = false;
+        }
+        // Hand finished readbacks over to the encoder
+        exporter->poll();
+
+        // The steps of the next frame only descend while SPACE is still held
+        descending = false;
     });
+    if (context->isHeadless()) {
+        capture();
+    }
+    exporter->flush();
 
     // Destroy all resources
-    engine->destroyEntity(ball->getEntity());
-    engine->destroyEntity(contourBall->getEntity());
-    engine->destroyEntity(mesh->getEntity());
-    engine->destroyEntity(aura->getEntity());
-    engine->destroyEntity(globalLight);
-    engine->destroyEntity(pointLight);
+    const Entity entities[]{
+        ball->getEntity(), contourBall->getEntity(), mesh->getEntity(), contour->getEntity(), aura->getEntity(),
+        globalLight, pointLight
+    };
+    engine->destroyEntities(entities);
     engine->destroyTexture(earthDiff);
     engine->destroyTexture(earthSpec);
-    engine->destroyShader(ball->getShader());
-    engine->destroyShader(contourBall->getShader());
-    engine->destroyShader(mesh->getShader());
-    engine->destroyShader(aura->getShader());
+    Shader* const shaders[]{
+        ball->getShader(), contourBall->getShader(), mesh->getShader(), contour->getShader(), aura->getShader()
+    };
+    engine->destroyShaders(shaders);
 
     engine->destroyRenderer(renderer);
     engine->destroyView(view);
@@ -446,13 +497,7 @@ int main() {
     engine->destroyScene(contourScene);
     engine->destroyCamera(camera->getEntity());
 
-    const auto entityManager = EntityManager::get();
-    entityManager->discard(ball->getEntity());
-    entityManager->discard(contourBall->getEntity());
-    entityManager->discard(mesh->getEntity());
-    entityManager->discard(aura->getEntity());
-    entityManager->discard(globalLight);
-    entityManager->discard(pointLight);
+    EntityManager::get()->discard(entities);
 
     // Free up any resources we may have forgotten to destroy
     engine->destroy();
@@ -493,6 +538,10 @@ glm::mat4 getContourBallTransform(const float x, const float y, const float radi
     return trans;
 }
 
-inline float getAuraVelocity(const long deltaTimeMillis, const float speed) {
-    return static_cast<float>(deltaTimeMillis) / 1000.0f * speed;
+inline float objectiveAt(const float x, const float y) {
+    return (x*x + y*y) / 40.0f + 2.0f * std::exp(-(std::cos(x / 2.0f) + y * y / 4.0f)) - std::cos(x / 1.5f) - std::sin(y / 1.5f);
+}
+
+inline float getAuraVelocity(const float deltaSeconds, const float speed) {
+    return deltaSeconds * speed;
 }
\ No newline at end of file
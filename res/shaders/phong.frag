@@ -26,112 +26,137 @@ struct DirectionalLight {
     vec3 specular;
 };
 
+// xyz: position, w: radius beyond which the light is ignored
+// The w of the others hold the constant, linear and quadratic attenuation terms in that order
 struct PointLight {
-    vec3 position;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    float constant;
-    float linear;
-    float quadratic;
+    vec4 positionRadius;
+    vec4 ambientConstant;
+    vec4 diffuseLinear;
+    vec4 specularQuadratic;
 };
 
+#ifdef TEXTURED
+uniform TexturedMaterial texturedMaterial;
+#else
 uniform Material material;
+#endif
+
+#define MAX_DIRECTIONAL_LIGHTS 4
+
+layout (std140, binding = 1) uniform Lights {
+    DirectionalLight directionalLights[MAX_DIRECTIONAL_LIGHTS];
+    // x: the number of directional lights
+    ivec4 lightCounts;
+    // xyz: the number of clusters along each axis, w: whether depth slices are logarithmic
+    uvec4 clusterGrid;
+    // x: slice scale, y: slice bias, z: near, w: far
+    vec4 clusterDepth;
+    // xy: origin, zw: size, in window coordinates
+    vec4 viewport;
+};
 
-uniform TexturedMaterial texturedMaterial;
-uniform bool enabledTexturedMaterial;
+layout (std430, binding = 2) readonly buffer PointLights {
+    PointLight pointLights[];
+};
+
+// x: offset into lightIndices, y: the number of lights of the cluster
+layout (std430, binding = 3) readonly buffer Clusters {
+    uvec2 clusters[];
+};
 
-uniform DirectionalLight directionalLight;
-uniform bool enabledDirectionalLight;
+layout (std430, binding = 4) readonly buffer LightIndices {
+    uint lightIndices[];
+};
 
-uniform PointLight pointLight;
-uniform bool enabledPointLight;
+vec3 calcDirLight(DirectionalLight light, vec3 normal, vec3 toView);
+vec3 calcPointLight(PointLight light, vec3 normal, vec3 toView);
+uint findCluster();
 
-vec3 calcDirLight(vec3 normal, vec3 toView);
-vec3 calcPointLight(vec3 normal, vec3 toView);
+vec3 surfaceAmbient();
+vec3 surfaceDiffuse();
+vec3 surfaceSpecular();
+float surfaceShininess();
 
 void main() {
     vec3 norm = normalize(fragNormal);
     vec3 toView = normalize(-fragPosition);
     
     vec3 shading = vec3(0.0f);
-    if (enabledDirectionalLight) {
-        shading += calcDirLight(norm, toView);
+    for (int i = 0; i < lightCounts.x; ++i) {
+        shading += calcDirLight(directionalLights[i], norm, toView);
     }
-    if (enabledPointLight) {
-        shading += calcPointLight(norm, toView);
+
+    // Only the point lights binned into the cluster of this fragment can reach it
+    uvec2 cluster = clusters[findCluster()];
+    for (uint i = 0u; i < cluster.y; ++i) {
+        shading += calcPointLight(pointLights[lightIndices[cluster.x + i]], norm, toView);
     }
 
 	FragColor = vec4(shading, 1.0f);
 }
 
-vec3 calcDirLight(vec3 normal, vec3 toView) {
+uint findCluster() {
+    uvec2 tile = uvec2((gl_FragCoord.xy - viewport.xy) / viewport.zw * vec2(clusterGrid.xy));
+    tile = min(tile, clusterGrid.xy - 1u);
+
+    float depth = clamp(-fragPosition.z, clusterDepth.z, clusterDepth.w);
+    float value = clusterGrid.w != 0u ? log(depth) : depth;
+    uint slice = uint(clamp(floor(value * clusterDepth.x - clusterDepth.y), 0.0f, float(clusterGrid.z - 1u)));
+
+    return tile.x + clusterGrid.x * (tile.y + clusterGrid.y * slice);
+}
+
+vec3 calcDirLight(DirectionalLight light, vec3 normal, vec3 toView) {
     // Ambient
-    vec3 ambient = directionalLight.ambient;
-    if (enabledTexturedMaterial) {
-        // Texture ambient should be the same as texture diffuse
-        ambient *= vec3(texture(texturedMaterial.diffuse, fragUV0));
-    } else {
-        ambient *= material.ambient;
-    }
+    vec3 ambient = light.ambient * surfaceAmbient();
     // Diffuse
-    vec3 toLight = normalize(-directionalLight.direction);
+    vec3 toLight = normalize(-light.direction);
     float diff = max(dot(normal, toLight), 0.0);
-    vec3 diffuse = directionalLight.diffuse * diff;
-    if (enabledTexturedMaterial) {
-        diffuse *= vec3(texture(texturedMaterial.diffuse, fragUV0));
-    } else {
-        diffuse *= material.diffuse;
-    }
+    vec3 diffuse = light.diffuse * diff * surfaceDiffuse();
     // Specular
     vec3 reflectDir = reflect(-toLight, normal);
-    vec3 specular = directionalLight.specular;
-    if (enabledTexturedMaterial) {
-        float spec = pow(max(dot(reflectDir, toView), 0.0f), texturedMaterial.shininess);
-        specular *= (spec * vec3(texture(texturedMaterial.specular, fragUV0)));
-    } else {
-        float spec = pow(max(dot(reflectDir, toView), 0.0f), material.shininess);
-        specular *= (spec * material.specular);
-    }
+    float spec = pow(max(dot(reflectDir, toView), 0.0f), surfaceShininess());
+    vec3 specular = light.specular * spec * surfaceSpecular();
 
     return ambient + diffuse + specular;
 }
 
-vec3 calcPointLight(vec3 normal, vec3 toView) {
-    // Ambient
-    vec3 ambient = pointLight.ambient;
-    if (enabledTexturedMaterial) {
-        // Texture ambient should be the same as texture diffuse
-        ambient *= vec3(texture(texturedMaterial.diffuse, fragUV0));
-    } else {
-        ambient *= material.ambient;
+vec3 calcPointLight(PointLight light, vec3 normal, vec3 toView) {
+    vec3 position = light.positionRadius.xyz;
+    float dist = length(position - fragPosition);
+    if (dist > light.positionRadius.w) {
+        return vec3(0.0f);
     }
+
+    // Ambient
+    vec3 ambient = light.ambientConstant.rgb * surfaceAmbient();
     // Diffuse
-    vec3 toLight = normalize(pointLight.position - fragPosition);
+    vec3 toLight = normalize(position - fragPosition);
     float diff = max(dot(normal, toLight), 0.0f);
-    vec3 diffuse = pointLight.diffuse * diff;
-    if (enabledTexturedMaterial) {
-        diffuse *= vec3(texture(texturedMaterial.diffuse, fragUV0));
-    } else {
-        diffuse *= material.diffuse;
-    }
+    vec3 diffuse = light.diffuseLinear.rgb * diff * surfaceDiffuse();
     // Specular
     vec3 reflectDir = reflect(-toLight, normal);
-    vec3 specular = pointLight.specular;
-    if (enabledTexturedMaterial) {
-        float spec = pow(max(dot(reflectDir, toView), 0.0f), texturedMaterial.shininess);
-        specular *= spec * vec3(texture(texturedMaterial.specular, fragUV0));
-    } else {
-        float spec = pow(max(dot(reflectDir, toView), 0.0f), material.shininess);
-        specular *= (spec * material.specular);
-    }
+    float spec = pow(max(dot(reflectDir, toView), 0.0f), surfaceShininess());
+    vec3 specular = light.specularQuadratic.rgb * spec * surfaceSpecular();
 
     // Attenuation
-    float dist = length(pointLight.position - fragPosition);
-    float attenuation = 1.0f / (pointLight.constant + pointLight.linear * dist + pointLight.quadratic * (dist * dist));
+    float attenuation = 1.0f / (light.ambientConstant.w + light.diffuseLinear.w * dist + light.specularQuadratic.w * (dist * dist));
     ambient *= attenuation;
     diffuse *= attenuation;
     specular *= attenuation;
 
     return ambient + diffuse + specular;
 }
+
+#ifdef TEXTURED
+// Texture ambient should be the same as texture diffuse
+vec3 surfaceAmbient() { return vec3(texture(texturedMaterial.diffuse, fragUV0)); }
+vec3 surfaceDiffuse() { return vec3(texture(texturedMaterial.diffuse, fragUV0)); }
+vec3 surfaceSpecular() { return vec3(texture(texturedMaterial.specular, fragUV0)); }
+float surfaceShininess() { return texturedMaterial.shininess; }
+#else
+vec3 surfaceAmbient() { return material.ambient; }
+vec3 surfaceDiffuse() { return material.diffuse; }
+vec3 surfaceSpecular() { return material.specular; }
+float surfaceShininess() { return material.shininess; }
+#endif
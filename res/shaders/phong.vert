@@ -1,26 +1,59 @@
 #version 440 core
 
 layout (location = 0) in vec3 position;
+#ifdef OCTAHEDRAL_NORMALS
+layout (location = 1) in vec2 octahedralNormal;
+#else
 layout (location = 1) in vec3 normal;
+#endif
 layout (location = 2) in vec4 color;
 layout (location = 3) in vec2 uv0;
 layout (location = 4) in vec2 uv1;
+#ifdef INSTANCED
+layout (location = 5) in mat4 instanceTransform;
+layout (location = 9) in vec4 instanceColor;
+#endif
 
 out vec3 fragPosition;
 out vec3 fragNormal;
 out vec4 fragColor;
 out vec2 fragUV0;
 
+layout (std140, binding = 0) uniform Camera {
+    mat4 view;
+    mat4 projection;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 uniform mat4 normalMat;
 
+#ifdef OCTAHEDRAL_NORMALS
+// Folds the lower half of the octahedron back under the upper one
+vec3 unfoldNormal(vec2 folded) {
+	vec3 n = vec3(folded, 1.0 - abs(folded.x) - abs(folded.y));
+	float t = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+	return normalize(n);
+}
+#endif
+
 void main() {
-	vec4 viewPos = view * model * vec4(position, 1.0f);
-	fragPosition = vec3(viewPos) / viewPos.w;
+#ifdef OCTAHEDRAL_NORMALS
+	vec3 normal = unfoldNormal(octahedralNormal);
+#endif
+#ifdef INSTANCED
+	mat4 modelMat = model * instanceTransform;
+	fragColor = color * instanceColor;
+	// Instance transforms only rotate, translate and scale uniformly, so they can transform normals directly
+	vec3 localNormal = mat3(instanceTransform) * normal;
+#else
+	mat4 modelMat = model;
 	fragColor = color;
-	fragNormal = vec3(normalMat * vec4(normal, 0.0));
+	vec3 localNormal = normal;
+#endif
+	vec4 viewPos = view * modelMat * vec4(position, 1.0f);
+	fragPosition = vec3(viewPos) / viewPos.w;
+	fragNormal = vec3(normalMat * vec4(localNormal, 0.0));
 
 	fragUV0 = uv0;
 
@@ -5,13 +5,14 @@ in vec2 fragUV0;
 
 out vec4 FragColor;
 
+#ifdef TEXTURED
 uniform sampler2D unlitTexture;
-uniform bool enabledUnlitTexture;
+#endif
 
 void main() {
-	if (enabledUnlitTexture) {
-		FragColor = texture(unlitTexture, fragUV0);
-	} else {
-		FragColor = fragColor;
-	}
+#ifdef TEXTURED
+	FragColor = texture(unlitTexture, fragUV0);
+#else
+	FragColor = fragColor;
+#endif
 }
\ No newline at end of file
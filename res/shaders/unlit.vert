@@ -1,20 +1,36 @@
 #version 440 core
 
 layout (location = 0) in vec3 position;
+#ifdef OCTAHEDRAL_NORMALS
+layout (location = 1) in vec2 octahedralNormal;
+#else
 layout (location = 1) in vec3 normal;
+#endif
 layout (location = 2) in vec4 color;
 layout (location = 3) in vec2 uv0;
 layout (location = 4) in vec2 uv1;
+#ifdef INSTANCED
+layout (location = 5) in mat4 instanceTransform;
+layout (location = 9) in vec4 instanceColor;
+#endif
 
 out vec4 fragColor;
 out vec2 fragUV0;
 
+layout (std140, binding = 0) uniform Camera {
+    mat4 view;
+    mat4 projection;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main() {
+#ifdef INSTANCED
+	gl_Position = projection * view * model * instanceTransform * vec4(position, 1.0f);
+    fragColor = color * instanceColor;
+#else
 	gl_Position = projection * view * model * vec4(position, 1.0f);
     fragColor = color;
+#endif
     fragUV0 = uv0;
 }
\ No newline at end of file
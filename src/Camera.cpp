@@ -22,16 +22,34 @@ void Camera::relativeZoom(const float amount) {
 
 void Camera::setProjection(const float fov, const float ratio, const float near, const float far) {
 	_projection = glm::perspective(fov, ratio, near, far);
+	_near = near;
+	_far = far;
+	_orthographic = false;
 }
 
 void Camera::setProjection(const float left, const float right, const float bottom, const float top, const float zNear, const float zFar) {
 	_projection = glm::ortho(left, right, bottom, top, zNear, zFar);
+	_near = zNear;
+	_far = zFar;
+	_orthographic = true;
 }
 
 glm::mat4 Camera::getProjection() const {
 	return _projection;
 }
 
+float Camera::getNear() const {
+	return _near;
+}
+
+float Camera::getFar() const {
+	return _far;
+}
+
+bool Camera::isOrthographic() const {
+	return _orthographic;
+}
+
 glm::mat4 Camera::getViewMatrix() const {
 	const auto pos = glm::vec3{
 		_radius * glm::sin(glm::radians(_theta)) * glm::cos(glm::radians(_phi)),
@@ -10,8 +10,10 @@
 #include <functional>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
 
 #include "Context.h"
+#include "utils/Profiler.h"
 
 static std::function<void(int, int)> mFramebufferCallback{ [](auto, auto) {} };
 static std::function<void(float)> mMouseScrollCallback{ [](auto) {} };
@@ -26,16 +28,73 @@ std::unique_ptr<Context> Context::create(const std::string_view name, const int
     return std::unique_ptr<Context>(new Context{ name, width, height });
 }
 
+std::unique_ptr<Context> Context::createHeadless(
+    const int width, const int height, const int frameCount, const std::chrono::nanoseconds frameTime, const Backend backend
+) {
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Context: headless framebuffer must have a positive size");
+    }
+    if (frameCount < 0 || frameTime.count() < 0) {
+        throw std::invalid_argument("Context: frame count and frame time must not be negative");
+    }
+    return std::unique_ptr<Context>(new Context{ width, height, frameCount, frameTime, backend });
+}
+
 Context::Context(const std::string_view name, const int width, const int height) {
+    initialize(name, width, height);
+}
+
+Context::Context(
+    const int width, const int height, const int frameCount, const std::chrono::nanoseconds frameTime, const Backend backend
+) : _headless{ true }, _frameCount{ frameCount }, _frameTime{ frameTime }, _width{ width }, _height{ height } {
+    // The window only carries the OpenGL context, it is never shown and its default framebuffer is never drawn to
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    switch (backend) {
+        case Backend::EGL:
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+            break;
+        case Backend::OSMESA:
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            break;
+        case Backend::NATIVE:
+            break;
+    }
+    initialize("Headless", width, height);
+
+    // Single-sampled so captures can read pixels straight from it
+    glGenRenderbuffers(1, &_colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, _colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &_depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, _depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        glfwTerminate();
+        throw std::runtime_error("Failed to create the off-screen framebuffer\n");
+    }
+}
+
+void Context::initialize(const std::string_view name, const int width, const int height) {
     // glfw: initialize and configure
     // ------------------------------
-    glfwInit();
+    if (!glfwInit()) {
+        throw std::runtime_error("Failed to initialize GLFW\n");
+    }
     // ensure when a user does not have the proper OpenGL version GLFW fails to run
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, VERSION_MAJOR);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, VERSION_MINOR);
     // access to smaller subset of OpenGL without backward-compatible features
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_SAMPLES, 4);
+    // A headless context has no use for a multisampled default framebuffer
+    glfwWindowHint(GLFW_SAMPLES, _headless ? 0 : 4);
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
@@ -82,9 +141,19 @@ void Context::setClose(const bool close) const {
 }
 
 Context::~Context() {
+    Profiler::get()->releaseQueries();
+    if (_framebuffer != 0) {
+        glDeleteFramebuffers(1, &_framebuffer);
+        glDeleteRenderbuffers(1, &_colorBuffer);
+        glDeleteRenderbuffers(1, &_depthBuffer);
+    }
     glfwTerminate();
 }
 
+bool Context::isHeadless() const {
+    return _headless;
+}
+
 void Context::setOnPress(const Key key, const std::function<void()>& listener) {
     _onPressListeners.emplace(key, OnPressListener{ listener, false });
 }
@@ -115,33 +184,133 @@ void Context::setMouseDragPerpetualCallback(const std::function<void(float, floa
 }
 
 void Context::loop(const std::function<void()>& onFrame) {
+    if (_headless) {
+        loopHeadless(onFrame);
+        return;
+    }
+
     // We make sure the framebuffer callback gets invoked before the rendering loop.
     int width, height;
     glfwGetFramebufferSize(_window, &width, &height);
     mFramebufferCallback(width, height);
 
+    // The first frame reports no elapsed time
+    auto lastPoint = std::chrono::steady_clock::now();
     while (!glfwWindowShouldClose(_window)) {
-        static const auto START_POINT = std::chrono::high_resolution_clock::now();
-        const auto currentPoint = std::chrono::high_resolution_clock::now();
-        const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(currentPoint - START_POINT);
-        _currentTime = std::chrono::duration<long, std::milli>(duration).count();
-        _deltaTime = _currentTime - _lastTime;
-        _lastTime = _currentTime;
+        const auto framePoint = std::chrono::steady_clock::now();
+        // Set before the input listeners run, since they scale their movements by it
+        _deltaTime = framePoint - lastPoint;
+        lastPoint = framePoint;
+
+        const auto profiler = Profiler::get();
+        profiler->beginFrame();
+        {
+            const auto scope = Profiler::Scope{ "input" };
+            processInputListeners();
+        }
+        {
+            const auto scope = Profiler::Scope{ "steps" };
+            advance(_deltaTime);
+        }
+        {
+            const auto scope = Profiler::Scope{ "onFrame" };
+            onFrame();
+        }
+        {
+            const auto scope = Profiler::Scope{ "events" };
+            glfwPollEvents();
+        }
+        {
+            const auto scope = Profiler::Scope{ "swap" };
+            glfwSwapBuffers(_window);
+        }
+        if (_minFrameTime.count() > 0) {
+            const auto scope = Profiler::Scope{ "pacing" };
+            // Sleeping gives the core back, the wake-up is a little late at worst which only lowers the rate slightly
+            std::this_thread::sleep_until(framePoint + _minFrameTime);
+        }
+        profiler->endFrame();
+    }
+}
+
+void Context::advance(const std::chrono::nanoseconds delta) {
+    if (_step.count() <= 0) {
+        return;
+    }
+
+    _accumulator += delta;
+    auto steps = 0;
+    while (_accumulator >= _step && steps < MAX_STEPS_PER_FRAME) {
+        _onStep(std::chrono::duration<float>(_step).count());
+        _accumulator -= _step;
+        ++steps;
+    }
+    // Too far behind to catch up, drop the backlog instead of spiralling
+    if (_accumulator >= _step) {
+        _accumulator %= _step;
+    }
+}
+
+void Context::setFixedStep(const std::chrono::nanoseconds step, const std::function<void(float)>& onStep) {
+    _step = step;
+    _onStep = onStep ? onStep : [](auto) {};
+    _accumulator = std::chrono::nanoseconds{ 0 };
+}
+
+void Context::setFrameRateCap(const int framesPerSecond) {
+    _minFrameTime = framesPerSecond > 0
+            ? std::chrono::nanoseconds{ std::chrono::seconds{ 1 } } / framesPerSecond
+            : std::chrono::nanoseconds{ 0 };
+}
 
-        processInputListeners();
+void Context::loopHeadless(const std::function<void()>& onFrame) {
+    mFramebufferCallback(_width, _height);
 
-        onFrame();
+    // Nothing else binds framebuffers, so everything rendered from here on lands in the off-screen target
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
 
-        glfwPollEvents();
-        glfwSwapBuffers(_window);
+    // Time advances by the fixed step only, so a run renders the same frames on any machine
+    for (auto frame = 0; frame < _frameCount && !glfwWindowShouldClose(_window); ++frame) {
+        const auto profiler = Profiler::get();
+        profiler->beginFrame();
+        {
+            const auto scope = Profiler::Scope{ "steps" };
+            _deltaTime = frame == 0 ? std::chrono::nanoseconds{ 0 } : _frameTime;
+            advance(_deltaTime);
+        }
+        {
+            const auto scope = Profiler::Scope{ "onFrame" };
+            onFrame();
+        }
+        profiler->endFrame();
     }
+    glFinish();
 }
 
-long Context::getDeltaTimeMillis() const {
+std::chrono::nanoseconds Context::getDeltaTime() const {
     return _deltaTime;
 }
 
+float Context::getDeltaSeconds() const {
+    return std::chrono::duration<float>(_deltaTime).count();
+}
+
+long Context::getDeltaTimeMillis() const {
+    return static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(_deltaTime).count());
+}
+
+float Context::getInterpolationAlpha() const {
+    if (_step.count() <= 0) {
+        return 1.0f;
+    }
+    return static_cast<float>(_accumulator.count()) / static_cast<float>(_step.count());
+}
+
 std::pair<int, int> Context::getFramebufferSize() const {
+    if (_headless) {
+        return std::make_pair(_width, _height);
+    }
     int width, height;
     glfwGetFramebufferSize(_window, &width, &height);
     return std::make_pair(width, height);
@@ -149,6 +318,10 @@ std::pair<int, int> Context::getFramebufferSize() const {
 
 void Context::setFramebufferCallback(const std::function<void(int, int)>& callback) const {
     mFramebufferCallback = callback;
+    if (_headless) {
+        // The off-screen framebuffer never changes size
+        return;
+    }
     glfwSetFramebufferSizeCallback(_window, [](auto _, const auto w, const auto h) {
         mFramebufferCallback(w, h);
     });
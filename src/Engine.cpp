@@ -14,6 +14,8 @@ std::unique_ptr<Engine> Engine::create() {
 Engine::Engine() {
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_MULTISAMPLE);
+	// The largest value of the index type ends a strip, so that one draw call covers several of them
+	glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
 }
 
 EntityManager* Engine::getEntityManager() const {
@@ -32,6 +34,14 @@ TransformManager* Engine::getTransformManager() const {
 	return _transformManager;
 }
 
+const Engine::ProgramStatistics& Engine::getProgramStatistics() const {
+	return _programStatistics;
+}
+
+void Engine::setProgramCacheDirectory(const std::string_view directory) {
+	_programCacheDirectory = directory;
+}
+
 Renderer* Engine::createRenderer() {
 	const auto renderer = new Renderer();
 	_renderers.insert(renderer);
@@ -41,6 +51,11 @@ Renderer* Engine::createRenderer() {
 void Engine::destroyRenderer(Renderer* const renderer) {
 	if (renderer) {
 		_renderers.erase(renderer);
+		glDeleteBuffers(1, &renderer->_cameraBlock);
+		glDeleteBuffers(1, &renderer->_lightBlock);
+		glDeleteBuffers(1, &renderer->_pointLightBuffer);
+		glDeleteBuffers(1, &renderer->_clusterBuffer);
+		glDeleteBuffers(1, &renderer->_lightIndexBuffer);
 		delete renderer;
 	}
 }
@@ -81,6 +96,11 @@ void Engine::destroyScene(Scene* const scene) {
 void Engine::destroyVertexBuffer(VertexBuffer* const buffer) {
 	if (buffer) {
 		_vertexBuffers.erase(buffer);
+		for (const auto& stream : buffer->_streams) {
+			for (const auto fence : stream.fences) {
+				glDeleteSync(fence);
+			}
+		}
 		glDeleteBuffers(buffer->getBufferCount(), buffer->_bufferObjects);
 		delete[] buffer->_bufferObjects;
 		delete buffer;
@@ -97,11 +117,31 @@ void Engine::destroyIndexBuffer(IndexBuffer* const buffer) {
 }
 
 void Engine::destroyShader(Shader* const shader) {
-	if (shader) {
+	destroyShaders(std::span(&shader, 1));
+}
+
+void Engine::destroyShaders(const std::span<Shader* const> shaders) {
+	// The programs are shared, each one only goes away along with its last Shader
+	auto programs = std::set<Shader::Program*>{};
+	for (const auto shader : shaders) {
+		if (!shader) {
+			continue;
+		}
 		_shaders.erase(shader);
-		glDeleteProgram(shader->getProgram());
+		if (const auto program = shader->_program; --program->users == 0) {
+			programs.insert(program);
+		}
 		delete shader;
 	}
+	if (programs.empty()) {
+		return;
+	}
+
+	std::erase_if(_programs, [&programs](const auto& entry) { return programs.contains(entry.second); });
+	for (const auto program : programs) {
+		glDeleteProgram(program->id);
+		delete program;
+	}
 }
 
 Camera* Engine::createCamera(const Entity entity) {
@@ -117,24 +157,40 @@ void Engine::destroyCamera(const Entity entity) {
 	}
 }
 
+std::vector<Entity> Engine::createEntities(const int count) const {
+	auto entities = std::vector<Entity>(count);
+	_entityManager->create(entities);
+	return entities;
+}
+
 void Engine::destroyEntity(const Entity entity) const {
-	if (_renderableManager->hasComponent(entity)) {
-		for (const auto& element : _renderableManager->_meshes[entity]->elements) {
-			glDeleteVertexArrays(1, &element->vao);
-		}
-		_renderableManager->_meshes.erase(entity);
+	destroyEntities(std::span(&entity, 1));
+}
 
-		// Remove the associated component of this entity
-		_entityManager->_entities[entity] = EntityManager::Component::NONE;
-		// ...and the associated transform also.
-		_transformManager->_transforms.erase(entity);
-	} else if (_lightManager->hasComponent(entity)) {
+void Engine::destroyEntities(const std::span<const Entity> entities) const {
+	auto vertexArrays = std::vector<GLuint>{};
+	auto buffers = std::vector<GLuint>{};
+	for (const auto entity : entities) {
+		if (const auto mesh = _renderableManager->_meshes.tryGet(entity)) {
+			for (const auto& element : mesh->elements) {
+				vertexArrays.push_back(element->vao);
+			}
+			if (mesh->instanceBuffer) {
+				buffers.push_back(mesh->instanceBuffer);
+			}
+			_renderableManager->_meshes.erase(entity);
+		}
 		_lightManager->_directionalLights.erase(entity);
 		_lightManager->_pointLights.erase(entity);
-		
-		_entityManager->_entities[entity] = EntityManager::Component::NONE;
-		_transformManager->_transforms.erase(entity);
 	}
+	if (!vertexArrays.empty()) {
+		glDeleteVertexArrays(static_cast<GLsizei>(vertexArrays.size()), vertexArrays.data());
+	}
+	if (!buffers.empty()) {
+		glDeleteBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
+	}
+	// ...and the associated transforms also.
+	_transformManager->remove(entities);
 }
 
 void Engine::destroyTexture(Texture* const texture) {
@@ -148,10 +204,13 @@ void Engine::destroyTexture(Texture* const texture) {
 
 void Engine::destroy() {
 	// Destroy any remaining renderable entities
-	for (const auto& mesh : _renderableManager->_meshes | std::views::values) {
-		for (const auto& element : mesh->elements) {
+	for (const auto& mesh : _renderableManager->_meshes.getComponents()) {
+		for (const auto& element : mesh.elements) {
 			glDeleteVertexArrays(1, &element->vao);
 		}
+		if (mesh.instanceBuffer) {
+			glDeleteBuffers(1, &mesh.instanceBuffer);
+		}
 	}
 	_renderableManager->_meshes.clear();
 
@@ -169,6 +228,11 @@ void Engine::destroy() {
 
 	// Destroy any remaining renderer
 	for (const auto renderer : _renderers) {
+		glDeleteBuffers(1, &renderer->_cameraBlock);
+		glDeleteBuffers(1, &renderer->_lightBlock);
+		glDeleteBuffers(1, &renderer->_pointLightBuffer);
+		glDeleteBuffers(1, &renderer->_clusterBuffer);
+		glDeleteBuffers(1, &renderer->_lightIndexBuffer);
 		delete renderer;
 	}
 	_renderers.clear();
@@ -187,6 +251,11 @@ void Engine::destroy() {
 
 	// Destroy any remaining vertex buffers
 	for (const auto& buffer : _vertexBuffers) {
+		for (const auto& stream : buffer->_streams) {
+			for (const auto fence : stream.fences) {
+				glDeleteSync(fence);
+			}
+		}
 		glDeleteBuffers(buffer->getBufferCount(), buffer->_bufferObjects);
 		delete[] buffer->_bufferObjects;
 		delete buffer;
@@ -203,11 +272,16 @@ void Engine::destroy() {
 
 	// Destroy any remaining shaders
 	for (const auto shader : _shaders) {
-		glDeleteProgram(shader->getProgram());
 		delete shader;
 	}
 	_shaders.clear();
 
+	for (const auto program : _programs | std::views::values) {
+		glDeleteProgram(program->id);
+		delete program;
+	}
+	_programs.clear();
+
 	// Destroy any remaining camera resources
 	for (const auto ptr : _cameras | std::views::values) {
 		delete ptr;
@@ -1,6 +1,8 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <stdexcept>
+
 #include "EntityManager.h"
 
 EntityManager* EntityManager::get() {
@@ -11,16 +13,43 @@ EntityManager* EntityManager::get() {
 }
 
 Entity EntityManager::create() {
-	auto entity = _next++;
-	_entities.emplace(entity, Component::NONE);
+	auto index = std::uint32_t{ 0 };
+	if (_freeIndices.size() > MIN_FREE_INDICES) {
+		index = _freeIndices.front();
+		_freeIndices.pop_front();
+	} else {
+		index = static_cast<std::uint32_t>(_generations.size());
+		if (index >= 1u << INDEX_BITS) {
+			throw std::length_error("[EntityManager] \t- Out of entity indices.");
+		}
+		_generations.push_back(0);
+	}
+	return index | static_cast<Entity>(_generations[index]) << INDEX_BITS;
+}
 
-	return entity;
+void EntityManager::create(const std::span<Entity> entities) {
+	_generations.reserve(_generations.size() + entities.size());
+	for (auto& entity : entities) {
+		entity = create();
+	}
 }
 
 bool EntityManager::isAlive(const Entity entity) const {
-	return _entities.contains(entity);
+	const auto index = getIndex(entity);
+	return index < _generations.size() && _generations[index] == getGeneration(entity);
 }
 
 void EntityManager::discard(const Entity entity) {
-	_entities.erase(entity);
+	if (!isAlive(entity)) {
+		return;
+	}
+	const auto index = getIndex(entity);
+	++_generations[index];
+	_freeIndices.push_back(index);
+}
+
+void EntityManager::discard(const std::span<const Entity> entities) {
+	for (const auto entity : entities) {
+		discard(entity);
+	}
 }
@@ -2,7 +2,10 @@
 // All rights reserved.
 
 #include <glad/glad.h>
+#include <limits>
+#include <stdexcept>
 #include <variant>
+#include <vector>
 
 #include "IndexBuffer.h"
 #include "Engine.h"
@@ -17,6 +20,11 @@ IndexBuffer::Builder& IndexBuffer::Builder::indexType(const IndexType type) {
 	return *this;
 }
 
+IndexBuffer::Builder& IndexBuffer::Builder::fitIndexType(const int vertexCount) {
+	_indexType = vertexCount <= MAX_USHORT_VERTICES ? IndexType::USHORT : IndexType::UINT;
+	return *this;
+}
+
 IndexBuffer* IndexBuffer::Builder::build(Engine& engine) const {
 	GLuint ibo;
 	glGenBuffers(1, &ibo);
@@ -33,7 +41,26 @@ IndexBuffer::Builder::IndexType IndexBuffer::getIndexType() const {
 	return _indexType;
 }
 
+int IndexBuffer::getIndexCount() const {
+	return _indexCount;
+}
+
 void IndexBuffer::setBuffer(const unsigned int* buffer) const {
+	if (_indexType == Builder::IndexType::USHORT) {
+		auto narrowed = std::vector<unsigned short>(_indexCount);
+		for (auto i = 0; i < _indexCount; ++i) {
+			if (buffer[i] == std::numeric_limits<unsigned int>::max()) {
+				narrowed[i] = std::numeric_limits<unsigned short>::max();
+			} else if (buffer[i] < MAX_USHORT_VERTICES) {
+				narrowed[i] = static_cast<unsigned short>(buffer[i]);
+			} else {
+				throw std::invalid_argument("[IndexBuffer] \t- Index out of range of 16-bit indices.");
+			}
+		}
+		setBuffer(narrowed.data());
+		return;
+	}
+
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
 
 	glBufferData(
@@ -45,6 +72,17 @@ void IndexBuffer::setBuffer(const unsigned int* buffer) const {
 }
 
 void IndexBuffer::setBuffer(const unsigned short* buffer) const {
+	if (_indexType == Builder::IndexType::UINT) {
+		auto widened = std::vector<unsigned int>(_indexCount);
+		for (auto i = 0; i < _indexCount; ++i) {
+			widened[i] = buffer[i] == std::numeric_limits<unsigned short>::max()
+				? std::numeric_limits<unsigned int>::max()
+				: buffer[i];
+		}
+		setBuffer(widened.data());
+		return;
+	}
+
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
 
 	glBufferData(
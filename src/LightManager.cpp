@@ -60,14 +60,12 @@ void LightManager::Builder::build(const Entity entity) const {
 		buildPointLight(entity);
 		break;
 	}
-	// Record this entity as light component
-	const auto entityManager = EntityManager::get();
-	entityManager->_entities[entity] = EntityManager::Component::LIGHT;
 }
 
 void LightManager::Builder::buildDirectionalLight(const Entity entity) const {
 	const auto lightManager = getInstance();
-	lightManager->_directionalLights[entity] = std::make_unique<DirectionalLight>(
+	lightManager->_directionalLights.emplace(
+		entity,
 		glm::vec3{ _dir[0], _dir[1], _dir[2] },
 		glm::vec3{ _ambient[0], _ambient[1], _ambient[2] },
 		glm::vec3{ _diffuse[0], _diffuse[1], _diffuse[2] },
@@ -78,7 +76,8 @@ void LightManager::Builder::buildDirectionalLight(const Entity entity) const {
 void LightManager::Builder::buildPointLight(const Entity entity) const {
 	const auto lightManager = getInstance();
 	const auto [constant, linear, quadratic] = resolveLightDistance();
-	lightManager->_pointLights[entity] = std::make_unique<PointLight>(
+	lightManager->_pointLights.emplace(
+		entity,
 		glm::vec3{ _pos[0], _pos[1], _pos[2] },
 		glm::vec3{ _ambient[0], _ambient[1], _ambient[2] },
 		glm::vec3{ _diffuse[0], _diffuse[1], _diffuse[2] },
@@ -121,7 +120,7 @@ bool LightManager::hasComponent(const Entity entity) const {
 }
 
 void LightManager::setPosition(const Entity light, const float x, const float y, const float z) {
-	if (_pointLights.contains(light)) {
-		_pointLights[light]->position = glm::vec3{x, y, z };
+	if (const auto pointLight = _pointLights.tryGet(light)) {
+		pointLight->position = glm::vec3{x, y, z };
 	}
 }
@@ -1,7 +1,14 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <glad/glad.h>
+#include <glm/common.hpp>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
 #include <utility>
 
 #include "RenderableManager.h"
@@ -24,27 +31,30 @@ RenderableManager::Builder& RenderableManager::Builder::geometry(
 	const VertexBuffer& vertices,
 	const IndexBuffer& indices,
 	const int count, 
-	const int offset
+	const int offset,
+	const int baseVertex
 ) {
 	GLuint vao;
 	glGenVertexArrays(1, &vao);
 	glBindVertexArray(vao);
 
-	// Configure vertex attributes
+	// Configure vertex attributes. Every attribute gets a binding point of its own so that streaming buffers can move
+	// it to another region of their ring by rebinding alone.
 	for (auto i = 0; i < vertices.getBufferCount(); ++i) {
-		glBindBuffer(GL_ARRAY_BUFFER, vertices._bufferObjects[i]);
+		const auto regionOffset = vertices.getRegionOffset(i);
 
 		for (const auto& [attr, type, byteOffset, byteStride] : vertices._layout[i]) {
 			const auto& [glType, components] = resolveAttributeType(type);
+			const auto location = static_cast<GLuint>(attr);
 
-			glVertexAttribPointer(
-				static_cast<GLuint>(attr), components, glType, vertices._normAttrs.contains(attr), byteStride, 
-				reinterpret_cast<void*>(static_cast<uint64_t>(byteOffset))	// NOLINT(performance-no-int-to-ptr)
+			glVertexAttribFormat(
+				location, components, glType,
+				VertexBuffer::resolveNormalized(type, vertices._normAttrs.contains(attr)), 0
 			);
-			glEnableVertexAttribArray(static_cast<GLuint>(attr));
+			glVertexAttribBinding(location, location);
+			glBindVertexBuffer(location, vertices._bufferObjects[i], regionOffset + byteOffset, byteStride);
+			glEnableVertexAttribArray(location);
 		}
-
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	// Configure indices
@@ -56,7 +66,7 @@ RenderableManager::Builder& RenderableManager::Builder::geometry(
 	const auto indexByteOffset = offset * resolveIndexSize(indices.getIndexType());
 	_elements[index] = std::make_unique<Element>(
 		vao, static_cast<GLenum>(topology), count, indexByteOffset,
-		static_cast<GLenum>(indices.getIndexType())
+		static_cast<GLenum>(indices.getIndexType()), baseVertex, &vertices
 	);
 	
 	return *this;
@@ -74,6 +84,17 @@ std::pair<int, int> RenderableManager::Builder::resolveAttributeType(const Verte
 		return std::make_pair(GL_FLOAT, 4);
 	case VertexBuffer::AttributeType::UINT:
 		return std::make_pair(GL_UNSIGNED_INT, 1);
+	case VertexBuffer::AttributeType::HALF2:
+		return std::make_pair(GL_HALF_FLOAT, 2);
+	case VertexBuffer::AttributeType::HALF4:
+		return std::make_pair(GL_HALF_FLOAT, 4);
+	case VertexBuffer::AttributeType::SHORT2:
+	case VertexBuffer::AttributeType::OCTAHEDRAL:
+		return std::make_pair(GL_SHORT, 2);
+	case VertexBuffer::AttributeType::SHORT4:
+		return std::make_pair(GL_SHORT, 4);
+	case VertexBuffer::AttributeType::INT_2_10_10_10_REV:
+		return std::make_pair(GL_INT_2_10_10_10_REV, 4);
 	}
 	return {};
 }
@@ -88,13 +109,99 @@ int RenderableManager::Builder::resolveIndexSize(const IndexBuffer::Builder::Ind
 	return 0;
 }
 
+RenderableManager::Builder& RenderableManager::Builder::instanced(const int capacity) {
+	_instanceCapacity = capacity < 1 ? 1 : capacity;
+	return *this;
+}
+
+RenderableManager::Builder& RenderableManager::Builder::boundingBox(const glm::vec3& min, const glm::vec3& max) {
+	_bounded = true;
+	_boundsMin = min;
+	_boundsMax = max;
+	return *this;
+}
+
+RenderableManager::Builder& RenderableManager::Builder::boundingBox(const std::vector<float>& positions) {
+	return boundingBox(positions.data(), static_cast<int>(positions.size() / 3), 3 * sizeof(float));
+}
+
+RenderableManager::Builder& RenderableManager::Builder::boundingBox(
+	const void* const positions, const int count, const int byteStride
+) {
+	auto min = glm::vec3{ std::numeric_limits<float>::max() };
+	auto max = glm::vec3{ std::numeric_limits<float>::lowest() };
+	const auto bytes = static_cast<const std::byte*>(positions);
+	for (auto i = 0; i < count; ++i) {
+		auto position = glm::vec3{};
+		std::memcpy(&position, bytes + static_cast<std::size_t>(i) * byteStride, sizeof(position));
+		// A single NaN or infinity would make the whole box meaningless
+		if (!std::isfinite(position.x) || !std::isfinite(position.y) || !std::isfinite(position.z)) {
+			continue;
+		}
+		min = glm::min(min, position);
+		max = glm::max(max, position);
+	}
+
+	// Without a single usable position we can't bound anything, leave the renderable unculled
+	if (min.x > max.x) {
+		_bounded = false;
+		return *this;
+	}
+	return boundingBox(min, max);
+}
+
 void RenderableManager::Builder::build(const Entity entity) {
 	const auto renderableManager = getInstance();
-	renderableManager->_meshes[entity] = std::make_unique<Mesh>(std::move(_elements), std::move(_shaders));
+	auto mesh = Mesh{ std::move(_elements), std::move(_shaders) };
+	mesh.bounded = _bounded;
+	mesh.boundsMin = _boundsMin;
+	mesh.boundsMax = _boundsMax;
+
+	if (_instanceCapacity > 0) {
+		for (const auto shader : mesh.shaders) {
+			if (!shader->hasFeature(Shader::Feature::INSTANCED)) {
+				std::cerr << "RenderableManager: Instanced renderables need shaders built with Feature::INSTANCED.\n";
+				throw std::invalid_argument("RenderableManager: Shader does not support instancing.\n");
+			}
+		}
+
+		glGenBuffers(1, &mesh.instanceBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, mesh.instanceBuffer);
+		glBufferData(
+			GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(Instance)) * _instanceCapacity, nullptr, GL_DYNAMIC_DRAW
+		);
+		mesh.instanceCapacity = _instanceCapacity;
+		mesh.instances.reserve(_instanceCapacity);
 
-	// Record this entity as renderable component
-	const auto entityManager = EntityManager::get();
-	entityManager->_entities[entity] = EntityManager::Component::RENDERABLE;
+		// Source the per-instance attributes of every element from the instance buffer
+		for (const auto& element : mesh.elements) {
+			glBindVertexArray(element->vao);
+
+			const auto transform = static_cast<GLuint>(VertexBuffer::VertexAttribute::INSTANCE_TRANSFORM);
+			for (auto column = 0u; column < 4u; ++column) {
+				const auto byteOffset = offsetof(Instance, transform) + column * sizeof(glm::vec4);
+				glVertexAttribPointer(
+					transform + column, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+					reinterpret_cast<void*>(byteOffset)	// NOLINT(performance-no-int-to-ptr)
+				);
+				glEnableVertexAttribArray(transform + column);
+				glVertexAttribDivisor(transform + column, 1);
+			}
+
+			const auto color = static_cast<GLuint>(VertexBuffer::VertexAttribute::INSTANCE_COLOR);
+			glVertexAttribPointer(
+				color, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+				reinterpret_cast<void*>(offsetof(Instance, color))	// NOLINT(performance-no-int-to-ptr)
+			);
+			glEnableVertexAttribArray(color);
+			glVertexAttribDivisor(color, 1);
+		}
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	renderableManager->_meshes.emplace(entity, std::move(mesh));
 }
 
 RenderableManager* RenderableManager::getInstance() {
@@ -108,6 +215,47 @@ bool RenderableManager::hasComponent(const Entity entity) const {
 	return _meshes.contains(entity);
 }
 
+void RenderableManager::addInstance(const Entity entity, const glm::mat4& transform, const glm::vec4& color) {
+	const auto mesh = _meshes.tryGet(entity);
+	if (!mesh || mesh->instanceBuffer == 0) {
+		throw std::invalid_argument("RenderableManager: Entity is not an instanced renderable.\n");
+	}
+	mesh->instances.emplace_back(transform, color);
+
+	glBindBuffer(GL_ARRAY_BUFFER, mesh->instanceBuffer);
+	if (mesh->instances.size() > mesh->instanceCapacity) {
+		// Out of room, reallocate with twice the capacity and upload everything
+		mesh->instanceCapacity *= 2;
+		glBufferData(
+			GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(Instance) * mesh->instanceCapacity), nullptr, GL_DYNAMIC_DRAW
+		);
+		glBufferSubData(
+			GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(Instance) * mesh->instances.size()),
+			mesh->instances.data()
+		);
+	} else {
+		// Only the new instance needs to go down to the GPU
+		glBufferSubData(
+			GL_ARRAY_BUFFER, static_cast<GLintptr>(sizeof(Instance) * (mesh->instances.size() - 1)),
+			sizeof(Instance), &mesh->instances.back()
+		);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void RenderableManager::clearInstances(const Entity entity) {
+	if (const auto mesh = _meshes.tryGet(entity)) {
+		mesh->instances.clear();
+	}
+}
+
+int RenderableManager::getInstanceCount(const Entity entity) const {
+	if (const auto mesh = _meshes.tryGet(entity)) {
+		return static_cast<int>(mesh->instances.size());
+	}
+	return 0;
+}
+
 
 
 
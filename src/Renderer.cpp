@@ -1,11 +1,21 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <glad/glad.h>
+#include <glm/geometric.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/mat3x3.hpp>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
 
 #include "Renderer.h"
 
@@ -13,8 +23,85 @@
 #include "RenderableManager.h"
 #include "TransformManager.h"
 #include "View.h"
+#include "utils/Profiler.h"
+
+// Mirrors of the std140 uniform blocks declared in the shaders, every vec3 starts on a 16-byte boundary
+namespace {
+	// Must match MAX_DIRECTIONAL_LIGHTS in res/shaders/phong.frag
+	constexpr auto MAX_DIRECTIONAL_LIGHTS = 4;
+
+	struct CameraBlock {
+		glm::mat4 view;
+		glm::mat4 projection;
+	};
+
+	struct DirectionalLightBlock {
+		alignas(16) glm::vec3 direction;
+		alignas(16) glm::vec3 ambient;
+		alignas(16) glm::vec3 diffuse;
+		alignas(16) glm::vec3 specular;
+	};
+
+	struct LightBlock {
+		DirectionalLightBlock directionalLights[MAX_DIRECTIONAL_LIGHTS]{};
+		// x: the number of directional lights
+		glm::ivec4 lightCounts{ 0 };
+		// x, y, z: the number of clusters along each axis, w: whether depth slices are logarithmic
+		glm::uvec4 clusterGrid{ 0 };
+		// x: slice scale, y: slice bias, z: near, w: far
+		glm::vec4 clusterDepth{ 0.0f };
+		// x, y: origin, z, w: size, in window coordinates
+		glm::vec4 viewport{ 0.0f };
+	};
+
+	static_assert(sizeof(DirectionalLightBlock) == 64);
+	static_assert(std::extent_v<decltype(LightBlock::directionalLights)> == MAX_DIRECTIONAL_LIGHTS);
+	static_assert(offsetof(LightBlock, lightCounts) == MAX_DIRECTIONAL_LIGHTS * sizeof(DirectionalLightBlock));
+	static_assert(offsetof(LightBlock, viewport) == offsetof(LightBlock, lightCounts) + 48);
+
+	// Point lights as laid out in the std430 PointLights storage block, four vec4 each:
+	// position and radius, ambient and constant, diffuse and linear, specular and quadratic
+	constexpr auto POINT_LIGHT_VEC4S = 4;
+
+	// A point light's contribution is considered gone once attenuated below this fraction of its brightest component
+	constexpr auto LIGHT_CUTOFF = 1.0f / 256.0f;
+
+	// Uploads data to a storage buffer and binds it, a buffer is never left empty since empty ones can't be bound
+	template <typename T>
+	void uploadStorage(const GLuint buffer, const GLuint binding, const std::vector<T>& data) {
+		static constexpr T EMPTY{};
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glBufferData(
+			GL_SHADER_STORAGE_BUFFER,
+			static_cast<GLsizeiptr>(sizeof(T) * std::max<std::size_t>(data.size(), 1)),
+			data.empty() ? &EMPTY : data.data(),
+			GL_DYNAMIC_DRAW
+		);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+	}
+}
+
+Renderer::Renderer() {
+	glGenBuffers(1, &_cameraBlock);
+	glBindBuffer(GL_UNIFORM_BUFFER, _cameraBlock);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+
+	glGenBuffers(1, &_lightBlock);
+	glBindBuffer(GL_UNIFORM_BUFFER, _lightBlock);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlock), nullptr, GL_DYNAMIC_DRAW);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glGenBuffers(1, &_pointLightBuffer);
+	glGenBuffers(1, &_clusterBuffer);
+	glGenBuffers(1, &_lightIndexBuffer);
+}
+
+void Renderer::render(const View& view) {
+	const auto profiler = Profiler::get();
+	const auto viewIndex = profiler->nextView();
+	const auto renderScope = Profiler::Scope{ "render", viewIndex };
 
-void Renderer::render(const View& view) const {
 	const auto vp = view.getViewport();
 	glViewport(vp[0], vp[1], vp[2], vp[3]);
 
@@ -33,10 +120,13 @@ void Renderer::render(const View& view) const {
         glClearColor(color[0], color[1], color[2], color[3]);
         clearMask |= GL_COLOR_BUFFER_BIT;
     }
-    glEnable(GL_SCISSOR_TEST);
-    glScissor(vp[0], vp[1], vp[2], vp[3]);
-	glClear(clearMask);
-    glDisable(GL_SCISSOR_TEST);
+	{
+		const auto clearScope = Profiler::GpuScope{ "clear", viewIndex };
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(vp[0], vp[1], vp[2], vp[3]);
+		glClear(clearMask);
+		glDisable(GL_SCISSOR_TEST);
+	}
 
 	const auto scene = view.getScene();
 	const auto camera = view.getCamera();
@@ -51,128 +141,491 @@ void Renderer::render(const View& view) const {
 		throw std::logic_error("Renderer: No camera was set for the view.\n");
 	}
 
-	// Render all renderables
+	// Camera and light states are the same for every draw of this view, upload them once
+	const auto viewMat = camera->getViewMatrix();
+	{
+		const auto lightScope = Profiler::Scope{ "lights", viewIndex };
+		updateCameraBlock(*camera);
+		prepareLights(*scene, viewMat);
+		assignLights(*camera);
+		updateLightBlock(vp);
+	}
+
+	_statistics = Statistics{};
+
+	// Gather the renderables along with their world-space bounds
+	_candidates.clear();
+	_bounds.clear();
+	const auto tcm = TransformManager::getInstance();
+	tcm->updateWorldTransforms();
+	const auto renderableManager = RenderableManager::getInstance();
 	for (const auto entity : scene->_renderables) {
-		// Compute MVP matrices
-		const auto tcm = TransformManager::getInstance();
-		auto modelMat = glm::mat4(1.0f);
-		if (tcm->_transforms.contains(entity)) {
-			modelMat = tcm->_transforms[entity];
+		const auto mesh = renderableManager->_meshes.tryGet(entity);
+		// Destroyed renderables left in the scene and instanced ones with no instances have nothing to draw
+		if (!mesh || (mesh->instanceBuffer && mesh->instances.empty())) {
+			continue;
+		}
+
+		const auto modelMat = tcm->getWorldTransform(entity);
+		_candidates.emplace_back(entity, modelMat);
+
+		if (mesh->bounded) {
+			// Transform the local box into the smallest world-space box enclosing it
+			const auto localCenter = (mesh->boundsMin + mesh->boundsMax) * 0.5f;
+			const auto localExtent = (mesh->boundsMax - mesh->boundsMin) * 0.5f;
+			const auto absolute = glm::mat3{
+				glm::vec3{ glm::abs(modelMat[0]) }, glm::vec3{ glm::abs(modelMat[1]) }, glm::vec3{ glm::abs(modelMat[2]) }
+			};
+			_bounds.push(glm::vec3(modelMat * glm::vec4(localCenter, 1.0f)), absolute * localExtent);
+		} else {
+			// A box this large passes every plane test, unlike an infinite one it can't produce NaNs
+			_bounds.push(glm::vec3{ 0.0f }, glm::vec3{ std::numeric_limits<float>::max() });
 		}
-		const auto viewMat = camera->getViewMatrix();
-		const auto projMat = camera->getProjection();
+	}
+
+	{
+		const auto cullScope = Profiler::Scope{ "cull", viewIndex };
+		cull(camera->getProjection() * viewMat);
+	}
+
+	// Gather a draw command for every element of every visible renderable
+	_queue.clear();
+	for (std::size_t c = 0; c < _candidates.size(); ++c) {
+		if (!_visibility[c]) {
+			++_statistics.culled;
+			continue;
+		}
+		++_statistics.visible;
+
+		const auto& [entity, modelMat] = _candidates[c];
 		// Compute the normal matrix to save computation resource on the GPU
 		const auto normalMat = glm::transpose(glm::inverse(viewMat * modelMat));
+		// Distance from the camera to the entity's origin, used to draw front to back within the same state
+		const auto depth = -(viewMat * modelMat[3]).z;
 
-		const auto renderableManager = RenderableManager::getInstance();
-		const auto& mesh = renderableManager->_meshes[entity];
-
-		// For each geometry in this renderable
-		for (std::size_t i = 0; i < mesh->elements.size(); ++i) {
-            // Each mesh has a corresponding shader
-			const auto shader = mesh->shaders[i];
-            // Specify which program to use first
-			shader->use();
-
-			// Set the MVP and the normal matrix
-			shader->setUniform(Shader::Uniform::MODEL, value_ptr(modelMat));
-			shader->setUniform(Shader::Uniform::VIEW, value_ptr(viewMat));
-			shader->setUniform(Shader::Uniform::PROJECTION, value_ptr(projMat));
-			shader->setUniform(Shader::Uniform::NORMAL_MAT, value_ptr(normalMat));
-
-			// Disable all lights in case no light is set for this scene
-			shader->setUniform(Shader::Uniform::ENABLED_DIRECTIONAL_LIGHT, false);
-			shader->setUniform(Shader::Uniform::ENABLED_POINT_LIGHT, false);
-
-			// Render all lights for this geometry
-			const auto lightManager = LightManager::getInstance();
-			for (const auto light : scene->_lights) {
-				if (lightManager->_directionalLights.contains(light)) {
-					const auto& dirLight = lightManager->_directionalLights[light];
-                    const auto lightNormalMat = glm::transpose(glm::inverse(viewMat * glm::mat4(1.0f)));
-                    const auto direction = glm::normalize(glm::vec3(lightNormalMat * glm::vec4(dirLight->direction, 0.0f)));
-					shader->setUniform(
-                        Shader::Uniform::DIRECTIONAL_LIGHT_DIRECTION,
-                        direction.x, direction.y, direction.z
-                    );
-					shader->setUniform(
-                        Shader::Uniform::DIRECTIONAL_LIGHT_AMBIENT,
-                        dirLight->ambient.x, dirLight->ambient.y, dirLight->ambient.z
-					);
-					shader->setUniform(
-						Shader::Uniform::DIRECTIONAL_LIGHT_DIFFUSE,
-						dirLight->diffuse.x, dirLight->diffuse.y, dirLight->diffuse.z
-					);
-					shader->setUniform(
-						Shader::Uniform::DIRECTIONAL_LIGHT_SPECULAR,
-						dirLight->specular.x, dirLight->specular.y, dirLight->specular.z
-					);
-					// Enable directional light
-					shader->setUniform(Shader::Uniform::ENABLED_DIRECTIONAL_LIGHT, true);
-				}
-				else if (lightManager->_pointLights.contains(light)) {
-					const auto& pointLight = lightManager->_pointLights[light];
-
-					// The position of point light in camera space
-					const auto lightPos = viewMat * glm::vec4{ pointLight->position, 1.0f };
-
-					shader->setUniform(
-						Shader::Uniform::POINT_LIGHT_POSITION,
-						lightPos.x / lightPos.w, lightPos.y / lightPos.w, lightPos.z / lightPos.w
-					);
-					shader->setUniform(
-						Shader::Uniform::POINT_LIGHT_AMBIENT,
-						pointLight->ambient.x, pointLight->ambient.y, pointLight->ambient.z
-					);
-					shader->setUniform(
-						Shader::Uniform::POINT_LIGHT_DIFFUSE,
-						pointLight->diffuse.x, pointLight->diffuse.y, pointLight->diffuse.z
-					);
-					shader->setUniform(
-						Shader::Uniform::POINT_LIGHT_SPECULAR,
-						pointLight->specular.x, pointLight->specular.y, pointLight->specular.z
-					);
-					shader->setUniform(Shader::Uniform::POINT_LIGHT_CONSTANT, pointLight->constant);
-					shader->setUniform(Shader::Uniform::POINT_LIGHT_LINEAR, pointLight->linear);
-					shader->setUniform(Shader::Uniform::POINT_LIGHT_QUADRATIC, pointLight->quadratic);
-					// Enable point light
-					shader->setUniform(Shader::Uniform::ENABLED_POINT_LIGHT, true);
-				}
+		const auto& mesh = renderableManager->_meshes.get(entity);
+		const auto instanceCount = static_cast<GLsizei>(mesh.instances.size());
+		for (std::size_t i = 0; i < mesh.elements.size(); ++i) {
+			const auto& element = mesh.elements[i];
+			const auto shader = mesh.shaders[i];
+			_queue.emplace_back(
+				makeSortKey(*shader, element->vao, depth), shader, element.get(), modelMat, normalMat, instanceCount
+			);
+		}
+	}
+
+	// Sort by state so that consecutive draws share as much as possible
+	std::ranges::sort(_queue, {}, &DrawCommand::key);
+
+	// Bindings may have been changed outside the renderer since the last call, start from a clean cache
+	_cache = StateCache{};
+	{
+		const auto drawScope = Profiler::Scope{ "draw", viewIndex };
+		const auto gpuDrawScope = Profiler::GpuScope{ "draw", viewIndex };
+		for (const auto& command : _queue) {
+			submit(command);
+		}
+		glBindVertexArray(0);
+	}
+
+	profiler->count({ _statistics.drawCalls, _statistics.stateChanges, _statistics.triangles });
+}
+
+void Renderer::BoundsArray::clear() {
+	centerX.clear(); centerY.clear(); centerZ.clear();
+	extentX.clear(); extentY.clear(); extentZ.clear();
+}
+
+void Renderer::BoundsArray::push(const glm::vec3& center, const glm::vec3& extent) {
+	centerX.push_back(center.x); centerY.push_back(center.y); centerZ.push_back(center.z);
+	extentX.push_back(extent.x); extentY.push_back(extent.y); extentZ.push_back(extent.z);
+}
+
+void Renderer::cull(const glm::mat4& viewProjection) {
+	// Extract the six frustum planes (Gribb & Hartmann), their normals point inside. Plane i is a*x + b*y + c*z + d.
+	const auto row = [&viewProjection](const int i) {
+		return glm::vec4{ viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i] };
+	};
+	const std::array planes{
+		row(3) + row(0), row(3) - row(0),
+		row(3) + row(1), row(3) - row(1),
+		row(3) + row(2), row(3) - row(2),
+	};
+
+	const auto count = _bounds.centerX.size();
+	_visibility.assign(count, 1);
+
+	const auto* const cx = _bounds.centerX.data();
+	const auto* const cy = _bounds.centerY.data();
+	const auto* const cz = _bounds.centerZ.data();
+	const auto* const ex = _bounds.extentX.data();
+	const auto* const ey = _bounds.extentY.data();
+	const auto* const ez = _bounds.extentZ.data();
+	auto* const visible = _visibility.data();
+
+	// A box is outside when even its corner furthest along a plane's normal is behind that plane
+	for (const auto& plane : planes) {
+		const auto absX = std::abs(plane.x);
+		const auto absY = std::abs(plane.y);
+		const auto absZ = std::abs(plane.z);
+		for (std::size_t i = 0; i < count; ++i) {
+			const auto distance = plane.x * cx[i] + plane.y * cy[i] + plane.z * cz[i] + plane.w;
+			const auto radius = absX * ex[i] + absY * ey[i] + absZ * ez[i];
+			visible[i] &= static_cast<std::uint8_t>(distance + radius >= 0.0f);
+		}
+	}
+}
+
+std::uint64_t Renderer::makeSortKey(const Shader& shader, const GLuint vao, const float depth) {
+	// The textures are hashed down to a few bits, a collision only costs some sorting quality since the state cache
+	// compares the actual bindings anyway.
+	auto textureHash = std::uint64_t{ 0 };
+	for (const auto& [target, texture] : shader.getTextureBindings()) {
+		textureHash = textureHash * 31 + texture;
+	}
+
+	// The bit pattern of a non-negative float grows with its value, its upper half makes a coarse depth.
+	const auto clampedDepth = std::max(depth, 0.0f);
+	const auto depthBits = std::bit_cast<std::uint32_t>(clampedDepth) >> 16;
+
+	// | model: 2 | program: 16 | textures: 14 | vao: 16 | depth: 16 |
+	return (static_cast<std::uint64_t>(shader.getModel()) & 0x3) << 62
+		| (static_cast<std::uint64_t>(shader.getProgram()) & 0xFFFF) << 46
+		| (textureHash & 0x3FFF) << 32
+		| (static_cast<std::uint64_t>(vao) & 0xFFFF) << 16
+		| (depthBits & 0xFFFF);
+}
+
+void Renderer::submit(const DrawCommand& command) {
+	const auto shader = command.shader;
+	const auto element = command.element;
+
+	bindProgram(shader->getProgram());
+
+	// The program may be shared with other Shaders, upload this Shader's material whenever we switch to it
+	if (_cache.shader != shader) {
+		shader->applyParameters();
+		_cache.shader = shader;
+	}
+
+	// Only the per-draw matrices are left to set, the rest comes from the uniform blocks
+	shader->uploadUniform(Shader::Uniform::MODEL, value_ptr(command.modelMat));
+	shader->uploadUniform(Shader::Uniform::NORMAL_MAT, value_ptr(command.normalMat));
+
+	const auto& textureBindings = shader->getTextureBindings();
+	// Bind the textures before the draw call
+	for (auto tex = 0; tex < static_cast<int>(textureBindings.size()); ++tex) {
+		const auto& [target, texture] = textureBindings[tex];
+		bindTexture(tex, target, texture);
+	}
+
+	// VAO will be linked to the currently used program
+	bindVertexArray(element->vao);
+	if (element->vertices->getUsage() == VertexBuffer::Usage::STREAM) {
+		element->vertices->bindStreams();
+	}
+
+	const auto indices = reinterpret_cast<void*>(static_cast<uint64_t>(element->offset)); // NOLINT(performance-no-int-to-ptr)
+	if (command.instanceCount > 0) {
+		glDrawElementsInstancedBaseVertex(
+			element->topology, static_cast<GLsizei>(element->count), element->indexType, indices,
+			command.instanceCount, element->baseVertex
+		);
+	} else {
+		glDrawElementsBaseVertex(
+			element->topology, static_cast<GLsizei>(element->count), element->indexType, indices, element->baseVertex
+		);
+	}
+	++_statistics.drawCalls;
+
+	const auto count = static_cast<std::int64_t>(element->count);
+	auto triangles = std::int64_t{ 0 };
+	if (element->topology == GL_TRIANGLES) {
+		triangles = count / 3;
+	} else if (element->topology == GL_TRIANGLE_STRIP || element->topology == GL_TRIANGLE_FAN) {
+		triangles = std::max<std::int64_t>(count - 2, 0);
+	}
+	_statistics.triangles += triangles * std::max(command.instanceCount, 1);
+}
+
+void Renderer::bindProgram(const GLuint program) {
+	if (_cache.program == program) {
+		++_statistics.stateChangesAvoided;
+		return;
+	}
+	glUseProgram(program);
+	_cache.program = program;
+	++_statistics.stateChanges;
+}
+
+void Renderer::bindVertexArray(const GLuint vao) {
+	if (_cache.vao == vao) {
+		++_statistics.stateChangesAvoided;
+		return;
+	}
+	glBindVertexArray(vao);
+	_cache.vao = vao;
+	++_statistics.stateChanges;
+}
+
+void Renderer::bindTexture(const int unit, const GLenum target, const GLuint texture) {
+	if (unit >= MAX_TEXTURE_UNITS) {
+		throw std::out_of_range("Renderer: Too many textures bound to a single shader.\n");
+	}
+	if (_cache.textures[unit] == std::make_pair(target, texture)) {
+		++_statistics.stateChangesAvoided;
+		return;
+	}
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(target, texture);
+	_cache.textures[unit] = std::make_pair(target, texture);
+	++_statistics.stateChanges;
+}
+
+void Renderer::updateCameraBlock(const Camera& camera) const {
+	const auto block = CameraBlock{ camera.getViewMatrix(), camera.getProjection() };
+	glBindBuffer(GL_UNIFORM_BUFFER, _cameraBlock);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, _cameraBlock);
+}
+
+void Renderer::LightArray::clear() {
+	directionX.clear();
+	directionY.clear();
+	directionZ.clear();
+	directionalAmbient.clear();
+	directionalDiffuse.clear();
+	directionalSpecular.clear();
+
+	positionX.clear();
+	positionY.clear();
+	positionZ.clear();
+	pointAmbient.clear();
+	pointDiffuse.clear();
+	pointSpecular.clear();
+	constant.clear();
+	linear.clear();
+	quadratic.clear();
+	radius.clear();
+}
+
+void Renderer::prepareLights(const Scene& scene, const glm::mat4& viewMat) {
+	// Gather the world-space data first
+	_lights.clear();
+	const auto lightManager = LightManager::getInstance();
+	for (const auto light : scene._lights) {
+		if (const auto dirLight = lightManager->_directionalLights.tryGet(light)) {
+			_lights.directionX.push_back(dirLight->direction.x);
+			_lights.directionY.push_back(dirLight->direction.y);
+			_lights.directionZ.push_back(dirLight->direction.z);
+			_lights.directionalAmbient.push_back(dirLight->ambient);
+			_lights.directionalDiffuse.push_back(dirLight->diffuse);
+			_lights.directionalSpecular.push_back(dirLight->specular);
+		}
+		if (const auto pointLight = lightManager->_pointLights.tryGet(light)) {
+			_lights.positionX.push_back(pointLight->position.x);
+			_lights.positionY.push_back(pointLight->position.y);
+			_lights.positionZ.push_back(pointLight->position.z);
+			_lights.pointAmbient.push_back(pointLight->ambient);
+			_lights.pointDiffuse.push_back(pointLight->diffuse);
+			_lights.pointSpecular.push_back(pointLight->specular);
+			_lights.constant.push_back(pointLight->constant);
+			_lights.linear.push_back(pointLight->linear);
+			_lights.quadratic.push_back(pointLight->quadratic);
+
+			// Solve constant + linear * d + quadratic * d^2 = brightest / LIGHT_CUTOFF for d
+			const auto brightest = std::max({
+				pointLight->ambient.r, pointLight->ambient.g, pointLight->ambient.b,
+				pointLight->diffuse.r, pointLight->diffuse.g, pointLight->diffuse.b,
+				pointLight->specular.r, pointLight->specular.g, pointLight->specular.b,
+			});
+			const auto c = pointLight->constant - brightest / LIGHT_CUTOFF;
+			const auto l = pointLight->linear;
+			const auto q = pointLight->quadratic;
+			auto radius = 0.0f;
+			if (c >= 0.0f) {
+				// Too dim to ever matter
+				radius = 0.0f;
+			} else if (q > 0.0f) {
+				radius = (-l + std::sqrt(l * l - 4.0f * q * c)) / (2.0f * q);
+			} else if (l > 0.0f) {
+				radius = -c / l;
+			} else {
+				// No attenuation at all, the light reaches everything
+				radius = std::numeric_limits<float>::max();
 			}
+			_lights.radius.push_back(radius);
+		}
+	}
 
-			// Draw using index buffer
-			const auto& element = mesh->elements[i];
-
-			// VAO will be linked to the currently used program
-			glBindVertexArray(element->vao);
-
-			// Enable texture bindings if there are textures set for this shader
-            const auto textureBindings = shader->getTextureBindings();
-            switch (shader->getModel()) {
-                case Shader::Model::UNLIT:
-                    shader->setUniform(Shader::Uniform::ENABLED_UNLIT_TEXTURE, !textureBindings.empty());
-                    break;
-                case Shader::Model::PHONG:
-                    shader->setUniform(Shader::Uniform::ENABLED_TEXTURED_MATERIAL, !textureBindings.empty());
-                    break;
-            }
-            // Bind the textures before the draw call
-            for (auto tex = 0; tex < static_cast<int>(textureBindings.size()); ++tex) {
-                glActiveTexture(GL_TEXTURE0 + tex);
-                const auto& [target, texture] = textureBindings[tex];
-                glBindTexture(target, texture);
-            }
-			
-			glDrawElements(
-				element->topology, static_cast<GLsizei>(element->count), element->indexType,
-				reinterpret_cast<void*>(static_cast<uint64_t>(element->offset)) // NOLINT(performance-no-int-to-ptr)
-			);
+	// Then move everything to camera space, where lights live in the shaders. Directions go through the normal matrix
+	// of the view, computed once for all of them.
+	const auto n = glm::transpose(glm::inverse(glm::mat3(viewMat)));
+	for (std::size_t i = 0; i < _lights.directionX.size(); ++i) {
+		const auto x = _lights.directionX[i];
+		const auto y = _lights.directionY[i];
+		const auto z = _lights.directionZ[i];
+		const auto tx = n[0][0] * x + n[1][0] * y + n[2][0] * z;
+		const auto ty = n[0][1] * x + n[1][1] * y + n[2][1] * z;
+		const auto tz = n[0][2] * x + n[1][2] * y + n[2][2] * z;
+		const auto inverseLength = 1.0f / std::sqrt(tx * tx + ty * ty + tz * tz);
+		_lights.directionX[i] = tx * inverseLength;
+		_lights.directionY[i] = ty * inverseLength;
+		_lights.directionZ[i] = tz * inverseLength;
+	}
+	// The view matrix is affine, positions need no perspective divide
+	const auto& v = viewMat;
+	for (std::size_t i = 0; i < _lights.positionX.size(); ++i) {
+		const auto x = _lights.positionX[i];
+		const auto y = _lights.positionY[i];
+		const auto z = _lights.positionZ[i];
+		_lights.positionX[i] = v[0][0] * x + v[1][0] * y + v[2][0] * z + v[3][0];
+		_lights.positionY[i] = v[0][1] * x + v[1][1] * y + v[2][1] * z + v[3][1];
+		_lights.positionZ[i] = v[0][2] * x + v[1][2] * y + v[2][2] * z + v[3][2];
+	}
+}
+
+void Renderer::assignLights(const Camera& camera) {
+	// Depth slices get thicker with the distance for perspective views, like the precision of the depth buffer
+	_logarithmicSlices = !camera.isOrthographic();
+	const auto near = _logarithmicSlices ? std::max(camera.getNear(), std::numeric_limits<float>::min()) : camera.getNear();
+	const auto far = std::max(camera.getFar(), near + std::numeric_limits<float>::epsilon());
+	if (_logarithmicSlices) {
+		const auto scale = static_cast<float>(CLUSTER_Z) / std::log(far / near);
+		_clusterDepth = glm::vec4{ scale, std::log(near) * scale, near, far };
+	} else {
+		const auto scale = static_cast<float>(CLUSTER_Z) / (far - near);
+		_clusterDepth = glm::vec4{ scale, near * scale, near, far };
+	}
+	const auto sliceAt = [this](const float depth) {
+		const auto value = _logarithmicSlices ? std::log(std::max(depth, _clusterDepth.z)) : depth;
+		const auto slice = std::floor(value * _clusterDepth.x - _clusterDepth.y);
+		return static_cast<int>(std::clamp(slice, 0.0f, static_cast<float>(CLUSTER_Z - 1)));
+	};
+	const auto tileAt = [](const float ndc, const int tiles) {
+		const auto tile = std::floor((ndc * 0.5f + 0.5f) * static_cast<float>(tiles));
+		return static_cast<int>(std::clamp(tile, 0.0f, static_cast<float>(tiles - 1)));
+	};
 
-			glBindVertexArray(0);
+	// The range of clusters every light may reach, as x0, x1, y0, y1, z0, z1, inclusive
+	const auto projection = camera.getProjection();
+	const auto lightCount = _lights.positionX.size();
+	auto reach = std::vector<std::array<int, 6>>(lightCount);
+	auto affecting = std::vector<std::uint8_t>(lightCount, 0);
+	for (std::size_t i = 0; i < lightCount; ++i) {
+		const auto center = glm::vec3{ _lights.positionX[i], _lights.positionY[i], _lights.positionZ[i] };
+		// The real reach decides which slices and tiles are covered, sliceAt() and tileAt() clamp to the grid. Only
+		// unbounded lights are capped, at a radius that still reaches every cluster.
+		const auto radius = std::min(_lights.radius[i], far + glm::length(center));
+		const auto closest = -center.z - radius;
+		const auto furthest = -center.z + radius;
+		if (radius <= 0.0f || furthest < near || closest > far) {
+			continue;
+		}
+
+		auto range = std::array{ 0, CLUSTER_X - 1, 0, CLUSTER_Y - 1, sliceAt(closest), sliceAt(furthest) };
+		// A sphere crossing the near plane of a perspective view can cover any part of the screen
+		if (!_logarithmicSlices || closest > near) {
+			auto ndcMin = glm::vec2{ std::numeric_limits<float>::max() };
+			auto ndcMax = glm::vec2{ std::numeric_limits<float>::lowest() };
+			for (auto corner = 0; corner < 8; ++corner) {
+				const auto offset = glm::vec3{
+					corner & 1 ? radius : -radius, corner & 2 ? radius : -radius, corner & 4 ? radius : -radius
+				};
+				const auto clip = projection * glm::vec4{ center + offset, 1.0f };
+				const auto ndc = glm::vec2{ clip } / clip.w;
+				ndcMin = glm::min(ndcMin, ndc);
+				ndcMax = glm::max(ndcMax, ndc);
+			}
+			if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f) {
+				continue;
+			}
+			range[0] = tileAt(ndcMin.x, CLUSTER_X);
+			range[1] = tileAt(ndcMax.x, CLUSTER_X);
+			range[2] = tileAt(ndcMin.y, CLUSTER_Y);
+			range[3] = tileAt(ndcMax.y, CLUSTER_Y);
+		}
+		reach[i] = range;
+		affecting[i] = 1;
+	}
+
+	// Count the lights of every cluster, turn the counts into offsets, then fill the index list
+	constexpr auto clusterCount = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+	_clusterRanges.assign(2 * clusterCount, 0);
+	const auto forEachCluster = [&reach](const std::size_t light, const auto& action) {
+		const auto& [x0, x1, y0, y1, z0, z1] = reach[light];
+		for (auto z = z0; z <= z1; ++z) {
+			for (auto y = y0; y <= y1; ++y) {
+				for (auto x = x0; x <= x1; ++x) {
+					action(x + CLUSTER_X * (y + CLUSTER_Y * z));
+				}
+			}
+		}
+	};
+	for (std::size_t i = 0; i < lightCount; ++i) {
+		if (affecting[i]) {
+			forEachCluster(i, [this](const int cluster) { ++_clusterRanges[2 * cluster + 1]; });
+		}
+	}
+	auto total = GLuint{ 0 };
+	for (auto cluster = 0; cluster < clusterCount; ++cluster) {
+		_clusterRanges[2 * cluster] = total;
+		total += _clusterRanges[2 * cluster + 1];
+		// Reset the count, it is rebuilt as the cursor of the fill below
+		_clusterRanges[2 * cluster + 1] = 0;
+	}
+	_lightIndices.resize(total);
+	for (std::size_t i = 0; i < lightCount; ++i) {
+		if (affecting[i]) {
+			forEachCluster(i, [this, i](const int cluster) {
+				const auto slot = _clusterRanges[2 * cluster] + _clusterRanges[2 * cluster + 1]++;
+				_lightIndices[slot] = static_cast<GLuint>(i);
+			});
 		}
 	}
 }
 
+void Renderer::updateLightBlock(const Viewport& viewport) {
+	auto block = LightBlock{};
+
+	const auto directionalCount = std::min(_lights.directionX.size(), static_cast<std::size_t>(MAX_DIRECTIONAL_LIGHTS));
+	if (directionalCount < _lights.directionX.size() && !_directionalLightsDropped) {
+		_directionalLightsDropped = true;
+		std::cerr << "Renderer: Only the first " << MAX_DIRECTIONAL_LIGHTS << " directional lights are used.\n";
+	}
+	for (std::size_t i = 0; i < directionalCount; ++i) {
+		auto& light = block.directionalLights[i];
+		light.direction = glm::vec3{ _lights.directionX[i], _lights.directionY[i], _lights.directionZ[i] };
+		light.ambient = _lights.directionalAmbient[i];
+		light.diffuse = _lights.directionalDiffuse[i];
+		light.specular = _lights.directionalSpecular[i];
+	}
+	block.lightCounts.x = static_cast<int>(directionalCount);
+	block.clusterGrid = glm::uvec4{ CLUSTER_X, CLUSTER_Y, CLUSTER_Z, _logarithmicSlices ? 1u : 0u };
+	block.clusterDepth = _clusterDepth;
+	block.viewport = glm::vec4{ viewport[0], viewport[1], viewport[2], viewport[3] };
+
+	glBindBuffer(GL_UNIFORM_BUFFER, _lightBlock);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightBlock), &block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, _lightBlock);
+
+	// Point lights go to their storage buffer in the std430 layout of the shaders
+	auto pointLights = std::vector<glm::vec4>{};
+	pointLights.reserve(POINT_LIGHT_VEC4S * _lights.positionX.size());
+	for (std::size_t i = 0; i < _lights.positionX.size(); ++i) {
+		pointLights.emplace_back(_lights.positionX[i], _lights.positionY[i], _lights.positionZ[i], _lights.radius[i]);
+		pointLights.emplace_back(_lights.pointAmbient[i], _lights.constant[i]);
+		pointLights.emplace_back(_lights.pointDiffuse[i], _lights.linear[i]);
+		pointLights.emplace_back(_lights.pointSpecular[i], _lights.quadratic[i]);
+	}
+	uploadStorage(_pointLightBuffer, POINT_LIGHT_BINDING, pointLights);
+	uploadStorage(_clusterBuffer, CLUSTER_BINDING, _clusterRanges);
+	uploadStorage(_lightIndexBuffer, LIGHT_INDEX_BINDING, _lightIndices);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
 void Renderer::setClearOptions(const ClearOptions& options) {
 	_clearOptions = options;
 }
@@ -181,6 +634,10 @@ Renderer::ClearOptions Renderer::getClearOptions() const {
 	return _clearOptions;
 }
 
+Renderer::Statistics Renderer::getStatistics() const {
+	return _statistics;
+}
+
 void Renderer::togglePolygonMode() {
 	if (_polygonMode == PolygonMode::FILL) {
 		_polygonMode = PolygonMode::LINE;
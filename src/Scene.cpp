@@ -1,16 +1,17 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include "LightManager.h"
+#include "RenderableManager.h"
 #include "Scene.h"
 
 void Scene::addEntity(const Entity entity) {
-	const auto entityManager = EntityManager::get();
-	if (entityManager->_entities.contains(entity)) {
-		if (entityManager->_entities[entity] == EntityManager::Component::RENDERABLE) {
-			_renderables.insert(entity);
-		} else if (entityManager->_entities[entity] == EntityManager::Component::LIGHT) {
-			_lights.insert(entity);
-		}
+	// An entity may carry both kinds of components
+	if (RenderableManager::getInstance()->hasComponent(entity)) {
+		_renderables.insert(entity);
+	}
+	if (LightManager::getInstance()->hasComponent(entity)) {
+		_lights.insert(entity);
 	}
 }
 
@@ -19,6 +20,12 @@ void Scene::removeEntity(const Entity entity) {
 	_lights.erase(entity);
 }
 
+void Scene::removeEntities(const std::span<const Entity> entities) {
+	for (const auto entity : entities) {
+		removeEntity(entity);
+	}
+}
+
 bool Scene::hasEntity(const Entity entity) const {
 	return _renderables.contains(entity) || _lights.contains(entity);
 }
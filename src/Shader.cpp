@@ -1,14 +1,44 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <sstream>
 #include <vector>
 #include <stdexcept>
 
 #include "Engine.h"
 #include "Shader.h"
 
+namespace {
+	constexpr auto FNV_OFFSET_BASIS = std::uint64_t{ 0xcbf29ce484222325 };
+	constexpr auto FNV_PRIME = std::uint64_t{ 0x100000001b3 };
+
+	// FNV-1a, chained through the seed so that several strings make up one key
+	std::uint64_t hash(std::uint64_t seed, const std::string_view data) {
+		for (const auto c : data) {
+			seed ^= static_cast<unsigned char>(c);
+			seed *= FNV_PRIME;
+		}
+		return seed;
+	}
+
+	constexpr auto BINARY_MAGIC = std::uint32_t{ 0x50474C43 };
+
+	// Precedes the driver's blob in a cached program binary
+	struct BinaryHeader {
+		std::uint32_t magic;
+		GLenum format;
+		std::uint64_t key;
+		std::uint32_t length;
+	};
+}
+
 std::pair<std::string, std::string> Shader::Builder::resolveShaderUri() const {
 	switch (_model) {
 	case Model::UNLIT: 
@@ -19,15 +49,34 @@ std::pair<std::string, std::string> Shader::Builder::resolveShaderUri() const {
 	return {};
 }
 
+Shader::Builder& Shader::Builder::feature(const Feature feature) {
+	_features |= static_cast<unsigned>(feature);
+	return *this;
+}
+
 Shader* Shader::Builder::build(Engine& engine) const {
-	const auto [vertShader, fragShader] = resolveShaderUri();
-	if (vertShader.empty() || fragShader.empty()) {
-		throw std::runtime_error("SHADER: Could not resolve shader paths.\n");
-	}
+	auto program = static_cast<Program*>(nullptr);
+	if (const auto found = engine._programs.find({ _model, _features }); found != engine._programs.end()) {
+		program = found->second;
+	} else {
+		const auto [vertShader, fragShader] = resolveShaderUri();
+		if (vertShader.empty() || fragShader.empty()) {
+			throw std::runtime_error("SHADER: Could not resolve shader paths.\n");
+		}
 
-	const auto program = createProgram(vertShader, fragShader);
-	const auto shader = new Shader(program, _model);
+		// The program is shared only once created, so that a build that throws leaves nothing behind to reuse
+		const auto start = std::chrono::steady_clock::now();
+		const auto id = createProgram(vertShader, fragShader, engine);
+		program = new Program{};
+		program->id = id;
+		program->resolveLocations();
+		engine._programs.emplace(std::make_pair(_model, _features), program);
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		engine._programStatistics.millis += std::chrono::duration<double, std::milli>(elapsed).count();
+	}
+	++program->users;
 
+	const auto shader = new Shader(program, _model, _features);
 	engine._shaders.insert(shader);
 
 	return shader;
@@ -35,17 +84,41 @@ Shader* Shader::Builder::build(Engine& engine) const {
 
 GLuint Shader::Builder::createProgram(
 	const std::string_view vertexShaderUri, 
-	const std::string_view fragmentShaderUri
-) {
-	const auto vertexShaderCode = readFile(vertexShaderUri);
-	const auto vertexShaderSource = vertexShaderCode.data();
+	const std::string_view fragmentShaderUri,
+	Engine& engine
+) const {
+	const auto vertexShaderCode = readSource(vertexShaderUri);
+	const auto fragmentShaderCode = readSource(fragmentShaderUri);
+
+	// A cached binary is only valid for the exact same sources on the exact same driver
+	auto cachePath = std::string{};
+	auto cacheKey = std::uint64_t{ 0 };
+	if (!engine._programCacheDirectory.empty()) {
+		cacheKey = hash(FNV_OFFSET_BASIS, vertexShaderCode);
+		cacheKey = hash(cacheKey, fragmentShaderCode);
+		for (const auto name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+			if (const auto value = glGetString(name)) {
+				cacheKey = hash(cacheKey, reinterpret_cast<const char*>(value));
+			}
+		}
+		auto fileName = std::ostringstream{};
+		fileName << std::hex << std::setw(16) << std::setfill('0') << cacheKey << ".bin";
+		cachePath = (std::filesystem::path{ engine._programCacheDirectory } / fileName.str()).string();
+
+		if (const auto program = loadProgramBinary(cachePath, cacheKey); program != 0) {
+			++engine._programStatistics.cacheHits;
+			return program;
+		}
+	}
+	++engine._programStatistics.cacheMisses;
+
+	const auto vertexShaderSource = vertexShaderCode.c_str();
 	const auto vertexShader = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
 	glCompileShader(vertexShader);
 	validateCompilation(vertexShader);
 
-	const auto fragmentShaderCode = readFile(fragmentShaderUri);
-	const auto fragmentShaderSource = fragmentShaderCode.data();
+	const auto fragmentShaderSource = fragmentShaderCode.c_str();
 	const auto fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
 	glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
 	glCompileShader(fragmentShader);
@@ -54,6 +127,9 @@ GLuint Shader::Builder::createProgram(
 	const auto shaderProgram = glCreateProgram();
 	glAttachShader(shaderProgram, vertexShader);
 	glAttachShader(shaderProgram, fragmentShader);
+	if (!cachePath.empty()) {
+		glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 	glLinkProgram(shaderProgram);
 	int success;
 	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
@@ -61,6 +137,8 @@ GLuint Shader::Builder::createProgram(
 		char infoLog[512];
 		glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
 		std::cout << "SHADER: Linking Failed\n" << infoLog << '\n';
+	} else if (!cachePath.empty()) {
+		saveProgramBinary(shaderProgram, cachePath, cacheKey);
 	}
 
 	glDeleteShader(vertexShader);
@@ -69,17 +147,27 @@ GLuint Shader::Builder::createProgram(
 	return shaderProgram;
 }
 
-std::vector<char> Shader::Builder::readFile(const std::string_view uri) {
-	auto file = std::ifstream(uri.data(), std::ios::ate);
+std::string Shader::Builder::readSource(const std::string_view uri) const {
+	auto file = std::ifstream(uri.data());
 	if (!file.is_open()) {
 		throw std::runtime_error("SHADER: Failed to open file!");
 	}
-	const auto fileSize = static_cast<size_t>(file.tellg());
-	auto buffer = std::vector<char>(fileSize);
-	file.seekg(0);
-	file.read(buffer.data(), static_cast<std::streamsize>(fileSize));
-	file.close();
-	return buffer;
+	auto source = std::string{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+	// The feature defines must come right after the #version directive
+	auto defines = std::string{};
+	if (_features & static_cast<unsigned>(Feature::TEXTURED)) {
+		defines += "#define TEXTURED\n";
+	}
+	if (_features & static_cast<unsigned>(Feature::INSTANCED)) {
+		defines += "#define INSTANCED\n";
+	}
+	if (_features & static_cast<unsigned>(Feature::OCTAHEDRAL_NORMALS)) {
+		defines += "#define OCTAHEDRAL_NORMALS\n";
+	}
+	const auto versionEnd = source.find('\n');
+	source.insert(versionEnd == std::string::npos ? source.size() : versionEnd + 1, defines);
+	return source;
 }
 
 void Shader::Builder::validateCompilation(const GLuint shader) {
@@ -92,45 +180,219 @@ void Shader::Builder::validateCompilation(const GLuint shader) {
 	}
 }
 
+GLuint Shader::Builder::loadProgramBinary(const std::string& path, const std::uint64_t key) {
+	auto file = std::ifstream(path, std::ios::binary);
+	if (!file.is_open()) {
+		return 0;
+	}
+
+	auto header = BinaryHeader{};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || header.magic != BINARY_MAGIC || header.key != key) {
+		return 0;
+	}
+	// A truncated or corrupt file is a miss too, the program is linked from source and the file written again
+	const auto start = file.tellg();
+	file.seekg(0, std::ios::end);
+	const auto remaining = file.tellg() - start;
+	file.seekg(start);
+	if (!file || header.length == 0 || static_cast<std::streamoff>(header.length) != remaining) {
+		return 0;
+	}
+	auto binary = std::vector<char>(header.length);
+	file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+	if (!file) {
+		return 0;
+	}
+
+	// The driver may still reject the binary, e.g. after an update that kept its version string
+	const auto program = glCreateProgram();
+	glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		std::cerr << "SHADER: Cached program binary was rejected, compiling from source.\n";
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+void Shader::Builder::saveProgramBinary(const GLuint program, const std::string& path, const std::uint64_t key) {
+	GLint length;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+
+	auto header = BinaryHeader{ BINARY_MAGIC, 0, key, static_cast<std::uint32_t>(length) };
+	auto binary = std::vector<char>(length);
+	glGetProgramBinary(program, length, nullptr, &header.format, binary.data());
+
+	// Failing to write the cache only costs a recompilation on the next launch
+	auto error = std::error_code{};
+	std::filesystem::create_directories(std::filesystem::path{ path }.parent_path(), error);
+	auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+	if (error || !file.is_open()) {
+		std::cerr << "SHADER: Could not write the program cache at " << path << '\n';
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+}
+
+Shader::Shader(Program* const program, const Model model, const unsigned features)
+	: _program{ program }, _model{ model }, _features{ features } {
+}
+
+void Shader::Program::resolveLocations() {
+	GLint uniformCount, maxNameLength;
+	glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	auto name = std::vector<char>(maxNameLength);
+	for (auto i = 0; i < uniformCount; ++i) {
+		GLsizei length;
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(id, static_cast<GLuint>(i), maxNameLength, &length, &size, &type, name.data());
+
+		// Uniforms living inside a block have no location and can't be set with glUniform*
+		const auto location = glGetUniformLocation(id, name.data());
+		if (location < 0) {
+			continue;
+		}
+
+		auto uniformName = std::string{ name.data(), static_cast<std::size_t>(length) };
+		// Arrays are reported as "name[0]", we make them addressable by their bare name as well
+		if (uniformName.ends_with("[0]")) {
+			locations.emplace(uniformName.substr(0, uniformName.size() - 3), location);
+		}
+		locations.emplace(std::move(uniformName), location);
+	}
+
+	// Uniforms not used by this shader model and features simply resolve to -1, which glUniform* silently ignores
+	handles.fill(-1);
+	for (const auto& uniform : Uniform::ALL) {
+		if (const auto it = locations.find(uniform.name); it != locations.end()) {
+			handles[uniform.index] = it->second;
+		}
+	}
+}
+
 GLuint Shader::getProgram() const {
-	return _program;
+	return _program->id;
 }
 
 Shader::Model Shader::getModel() const {
 	return _model;
 }
 
-std::vector<std::pair<GLenum, GLuint>> Shader::getTextureBindings() const {
+bool Shader::hasFeature(const Feature feature) const {
+	return (_features & static_cast<unsigned>(feature)) != 0;
+}
+
+const std::vector<std::pair<GLenum, GLuint>>& Shader::getTextureBindings() const {
     return _textureBindings;
 }
 
 void Shader::use() const {
-	glUseProgram(_program);
+	glUseProgram(_program->id);
+}
+
+GLint Shader::getLocation(const std::string_view name) const {
+	if (const auto it = _program->locations.find(name); it != _program->locations.end()) {
+		return it->second;
+	}
+	return -1;
+}
+
+void Shader::setUniform(const Uniform::Id uniform, const bool value) {
+	const auto data = value ? 1.0f : 0.0f;
+	setParameter(_program->handles[uniform.index], Parameter::Type::INT, &data, 1);
+}
+
+void Shader::setUniform(const Uniform::Id uniform, const float* const matrix) {
+	setParameter(_program->handles[uniform.index], Parameter::Type::MAT4, matrix, 16);
+}
+
+void Shader::setUniform(const Uniform::Id uniform, const float value) {
+	setParameter(_program->handles[uniform.index], Parameter::Type::FLOAT, &value, 1);
+}
+
+void Shader::setUniform(const Uniform::Id uniform, const float x, const float y, const float z) {
+	const float data[]{ x, y, z };
+	setParameter(_program->handles[uniform.index], Parameter::Type::FLOAT3, data, 3);
+}
+
+void Shader::setUniform(const Uniform::Id uniform, const Texture& texture) {
+    setTextureUnit(_program->handles[uniform.index], texture);
 }
 
-void Shader::setUniform(const std::string_view name, const bool value) const {
-	const auto location = glGetUniformLocation(_program, name.data());
-	glUniform1i(location, value);
+void Shader::setUniform(const std::string_view name, const bool value) {
+	const auto data = value ? 1.0f : 0.0f;
+	setParameter(getLocation(name), Parameter::Type::INT, &data, 1);
 }
 
-void Shader::setUniform(const std::string_view name, const float* const matrix) const {
-	const auto location = glGetUniformLocation(_program, name.data());
-	glUniformMatrix4fv(location, 1, GL_FALSE, matrix);
+void Shader::setUniform(const std::string_view name, const float* const matrix) {
+	setParameter(getLocation(name), Parameter::Type::MAT4, matrix, 16);
 }
 
-void Shader::setUniform(const std::string_view name, const float value) const {
-	const auto location = glGetUniformLocation(_program, name.data());
-	glUniform1f(location, value);
+void Shader::setUniform(const std::string_view name, const float value) {
+	setParameter(getLocation(name), Parameter::Type::FLOAT, &value, 1);
 }
 
-void Shader::setUniform(const std::string_view name, const float x, const float y, const float z) const {
-	const auto location = glGetUniformLocation(_program, name.data());
-	glUniform3f(location, x, y, z);
+void Shader::setUniform(const std::string_view name, const float x, const float y, const float z) {
+	const float data[]{ x, y, z };
+	setParameter(getLocation(name), Parameter::Type::FLOAT3, data, 3);
 }
 
 void Shader::setUniform(const std::string_view name, const Texture &texture) {
-    const auto location = glGetUniformLocation(_program, name.data());
-    const auto texUnit = static_cast<int>(_textureBindings.size());
-    glUniform1i(location, texUnit);
+    setTextureUnit(getLocation(name), texture);
+}
+
+void Shader::setParameter(const GLint location, const Parameter::Type type, const float* const value, const std::size_t count) {
+	// Uniforms the program doesn't have would be ignored by GL anyway
+	if (location < 0) {
+		return;
+	}
+
+	auto parameter = Parameter{ location, type, {} };
+	std::copy_n(value, count, parameter.value.begin());
+
+	const auto it = std::ranges::find(_parameters, location, &Parameter::location);
+	if (it != _parameters.end()) {
+		*it = parameter;
+	} else {
+		_parameters.push_back(parameter);
+	}
+}
+
+void Shader::setTextureUnit(const GLint location, const Texture& texture) {
+    const auto texUnit = static_cast<float>(_textureBindings.size());
+    setParameter(location, Parameter::Type::INT, &texUnit, 1);
     _textureBindings.emplace_back(texture.getTarget(), texture.getNativeObject());
-}
\ No newline at end of file
+}
+
+void Shader::applyParameters() const {
+	for (const auto& [location, type, value] : _parameters) {
+		switch (type) {
+			case Parameter::Type::INT:
+				glUniform1i(location, static_cast<GLint>(value[0]));
+				break;
+			case Parameter::Type::FLOAT:
+				glUniform1f(location, value[0]);
+				break;
+			case Parameter::Type::FLOAT3:
+				glUniform3f(location, value[0], value[1], value[2]);
+				break;
+			case Parameter::Type::MAT4:
+				glUniformMatrix4fv(location, 1, GL_FALSE, value.data());
+				break;
+		}
+	}
+}
+
+void Shader::uploadUniform(const Uniform::Id uniform, const float* const matrix) const {
+	glUniformMatrix4fv(_program->handles[uniform.index], 1, GL_FALSE, matrix);
+}
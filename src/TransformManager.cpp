@@ -1,6 +1,9 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <algorithm>
+#include <stdexcept>
+
 #include "TransformManager.h"
 
 TransformManager* TransformManager::getInstance() {
@@ -11,12 +14,181 @@ TransformManager* TransformManager::getInstance() {
 }
 
 void TransformManager::setTransform(const Entity entity, const glm::mat4& transform) {
-	_transforms[entity] = transform;
+	const auto index = obtainIndex(entity);
+	_locals[index] = transform;
+	_dirty[index] = 1;
 }
 
 glm::mat4 TransformManager::getTransform(const Entity entity) const {
-	if (_transforms.contains(entity)) {
-		return _transforms.at(entity);
+	const auto index = findIndex(entity);
+	return index == NONE ? glm::mat4(1.0f) : _locals[index];
+}
+
+glm::mat4 TransformManager::getWorldTransform(const Entity entity) const {
+	const auto index = findIndex(entity);
+	return index == NONE ? glm::mat4(1.0f) : _worlds[index];
+}
+
+void TransformManager::setParent(const Entity child, const Entity parent) {
+	const auto childIndex = obtainIndex(child);
+	const auto parentIndex = obtainIndex(parent);
+	for (auto ancestor = parentIndex; ancestor != NONE; ancestor = _parents[ancestor]) {
+		if (ancestor == childIndex) {
+			throw std::invalid_argument("[TransformManager] \t- An entity can't be parented to itself or its descendants.");
+		}
+	}
+	_parents[childIndex] = parentIndex;
+	_dirty[childIndex] = 1;
+	_hierarchyChanged = true;
+}
+
+void TransformManager::clearParent(const Entity entity) {
+	const auto index = findIndex(entity);
+	if (index == NONE || _parents[index] == NONE) {
+		return;
+	}
+	_parents[index] = NONE;
+	_dirty[index] = 1;
+	_hierarchyChanged = true;
+}
+
+bool TransformManager::hasComponent(const Entity entity) const {
+	return findIndex(entity) != NONE;
+}
+
+void TransformManager::updateWorldTransforms() {
+	if (_hierarchyChanged) {
+		sortHierarchy();
+	}
+	// Parents come first, so a node knows whether its parent's world transform changed by the time it is visited
+	for (const auto index : _order) {
+		const auto parent = _parents[index];
+		if (parent != NONE && _dirty[parent]) {
+			_dirty[index] = 1;
+		}
+		if (_dirty[index]) {
+			_worlds[index] = parent == NONE ? _locals[index] : _worlds[parent] * _locals[index];
+		}
+	}
+	// Clearing afterwards keeps the flags of parents valid for the whole pass
+	std::ranges::fill(_dirty, std::uint8_t{ 0 });
+}
+
+int TransformManager::findIndex(const Entity entity) const {
+	const auto sparse = EntityManager::getIndex(entity);
+	if (sparse >= _indices.size() || _indices[sparse] == NONE || _entities[_indices[sparse]] != entity) {
+		return NONE;
+	}
+	return _indices[sparse];
+}
+
+int TransformManager::obtainIndex(const Entity entity) {
+	const auto sparse = EntityManager::getIndex(entity);
+	if (sparse >= _indices.size()) {
+		_indices.resize(sparse + 1, NONE);
+	}
+	// A transform left over by a discarded entity of the same index goes first
+	if (_indices[sparse] != NONE && _entities[_indices[sparse]] != entity) {
+		remove(_entities[_indices[sparse]]);
 	}
-	return glm::mat4(1.0f);
-}
\ No newline at end of file
+	if (_indices[sparse] == NONE) {
+		_indices[sparse] = static_cast<int>(_entities.size());
+		_entities.push_back(entity);
+		_locals.emplace_back(1.0f);
+		_worlds.emplace_back(1.0f);
+		_parents.push_back(NONE);
+		_dirty.push_back(1);
+		_hierarchyChanged = true;
+	}
+	return _indices[entity];
+}
+
+void TransformManager::remove(const Entity entity) {
+	remove(std::span(&entity, 1));
+}
+
+void TransformManager::remove(const std::span<const Entity> entities) {
+	auto removed = std::vector<std::uint8_t>(_entities.size(), 0);
+	auto removedCount = 0;
+	for (const auto entity : entities) {
+		if (const auto index = findIndex(entity); index != NONE && !removed[index]) {
+			removed[index] = 1;
+			++removedCount;
+		}
+	}
+	if (removedCount == 0) {
+		return;
+	}
+
+	// Survivors keep their relative order, so parents can be remapped before they move
+	const auto count = static_cast<int>(_entities.size());
+	auto remap = std::vector<int>(count, NONE);
+	auto survivors = 0;
+	for (auto i = 0; i < count; ++i) {
+		if (!removed[i]) {
+			remap[i] = survivors++;
+		}
+	}
+
+	// Slide every survivor down to its new index, slots at or past the current one are still untouched
+	for (auto i = 0; i < count; ++i) {
+		if (removed[i]) {
+			_indices[EntityManager::getIndex(_entities[i])] = NONE;
+			continue;
+		}
+		auto parent = _parents[i];
+		if (parent != NONE && removed[parent]) {
+			// Orphans keep their place in the world
+			_locals[i] = _worlds[i];
+			parent = NONE;
+			_dirty[i] = 1;
+		}
+		const auto target = remap[i];
+		_entities[target] = _entities[i];
+		_locals[target] = _locals[i];
+		_worlds[target] = _worlds[i];
+		_parents[target] = parent == NONE ? NONE : remap[parent];
+		_dirty[target] = _dirty[i];
+		_indices[EntityManager::getIndex(_entities[target])] = target;
+	}
+
+	_entities.resize(survivors);
+	_locals.resize(survivors);
+	_worlds.resize(survivors);
+	_parents.resize(survivors);
+	_dirty.resize(survivors);
+	_hierarchyChanged = true;
+}
+
+void TransformManager::sortHierarchy() {
+	// Order by depth, which puts every parent before its children
+	const auto count = static_cast<int>(_entities.size());
+	auto depths = std::vector<int>(count, NONE);
+	auto maxDepth = 0;
+	for (auto i = 0; i < count; ++i) {
+		auto depth = 0;
+		for (auto ancestor = _parents[i]; ancestor != NONE; ancestor = _parents[ancestor]) {
+			if (depths[ancestor] != NONE) {
+				depth += depths[ancestor] + 1;
+				break;
+			}
+			++depth;
+		}
+		depths[i] = depth;
+		maxDepth = std::max(maxDepth, depth);
+	}
+
+	// A counting sort keeps the order stable within a depth
+	auto starts = std::vector<int>(maxDepth + 2, 0);
+	for (const auto depth : depths) {
+		++starts[depth + 1];
+	}
+	for (auto d = 1; d < static_cast<int>(starts.size()); ++d) {
+		starts[d] += starts[d - 1];
+	}
+	_order.resize(count);
+	for (auto i = 0; i < count; ++i) {
+		_order[starts[depths[i]]++] = i;
+	}
+	_hierarchyChanged = false;
+}
@@ -1,17 +1,163 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <iostream>
 #include <stdexcept>
 #include <utility>
 #include <ranges>
 
+// GCC and Clang can compile the F16C path into any x86 build and pick it at run time
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CG2023_F16C_DISPATCH
+#include <immintrin.h>
+#endif
+
 #include "VertexBuffer.h"
 #include "Engine.h"
 
+namespace {
+	// One second, in nanoseconds
+	constexpr auto FENCE_TIMEOUT = GLuint64{ 1'000'000'000 };
+
+	// Rounds to the nearest half float, ties to even, the way the hardware converters do
+	std::uint16_t toHalf(const float value) {
+		const auto bits = std::bit_cast<std::uint32_t>(value);
+		const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+		const auto biased = static_cast<int>((bits >> 23) & 0xFFu);
+		auto mantissa = bits & 0x7FFFFFu;
+
+		if (biased == 0xFF) {
+			// Infinities stay infinite, NaNs stay NaNs
+			return sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0u);
+		}
+		const auto exponent = biased - 127 + 15;
+		if (exponent >= 31) {
+			return sign | 0x7C00u;
+		}
+		if (exponent <= 0) {
+			// Subnormal halves, or zero once the value is too small for those
+			if (exponent < -10) {
+				return sign;
+			}
+			mantissa |= 0x800000u;
+			const auto shift = static_cast<unsigned>(14 - exponent);
+			auto half = mantissa >> shift;
+			const auto remainder = mantissa & ((1u << shift) - 1);
+			const auto halfway = 1u << (shift - 1);
+			if (remainder > halfway || (remainder == halfway && (half & 1u) != 0)) {
+				++half;
+			}
+			return static_cast<std::uint16_t>(sign | half);
+		}
+		// A carry out of the mantissa correctly bumps the exponent, up to infinity
+		auto half = static_cast<std::uint32_t>(sign) | (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+		const auto remainder = mantissa & 0x1FFFu;
+		if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u) != 0)) {
+			++half;
+		}
+		return static_cast<std::uint16_t>(half);
+	}
+
+#ifdef CG2023_F16C_DISPATCH
+	/**
+	 * Converts floats to half floats eight at a time, only callable once the CPU is known to support F16C.
+	 * @return The number of values converted, a multiple of eight.
+	 */
+	__attribute__((target("avx,f16c")))
+	std::size_t encodeHalfF16c(const float* const values, std::uint16_t* const halves, const std::size_t count) {
+		auto i = std::size_t{ 0 };
+		for (; i + 8 <= count; i += 8) {
+			const auto converted = _mm256_cvtps_ph(_mm256_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(halves + i), converted);
+		}
+		return i;
+	}
+#endif
+
+	// Converts count floats to half floats, eight at a time where the CPU has F16C
+	void encodeHalf(const float* const values, std::uint16_t* const halves, const std::size_t count) {
+		auto i = std::size_t{ 0 };
+#ifdef CG2023_F16C_DISPATCH
+		static const auto hasF16c = __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+		if (hasF16c) {
+			i = encodeHalfF16c(values, halves, count);
+		}
+#endif
+		for (; i < count; ++i) {
+			halves[i] = toHalf(values[i]);
+		}
+	}
+
+	// Maps count floats from [-1, 1] onto 16-bit signed integers, NaNs onto 0. The loop is branch-free so that it
+	// vectorizes.
+	void encodeSnorm16(const float* const values, std::int16_t* const shorts, const std::size_t count) {
+		for (auto i = std::size_t{ 0 }; i < count; ++i) {
+			const auto value = values[i] == values[i] ? values[i] : 0.0f;
+			const auto scaled = std::clamp(value, -1.0f, 1.0f) * 32767.0f;
+			shorts[i] = static_cast<std::int16_t>(scaled + std::copysign(0.5f, scaled));
+		}
+	}
+
+	// Projects count unit vectors, three floats each, onto the octahedron and unfolds its lower half over the upper
+	// one, which leaves two components per vector in [-1, 1]
+	void encodeOctahedral(const float* const vectors, float* const folded, const std::size_t count) {
+		for (auto i = std::size_t{ 0 }; i < count; ++i) {
+			const auto x = vectors[3 * i];
+			const auto y = vectors[3 * i + 1];
+			const auto z = vectors[3 * i + 2];
+			const auto norm = std::abs(x) + std::abs(y) + std::abs(z);
+			const auto scale = norm > 0.0f ? 1.0f / norm : 0.0f;
+			const auto px = x * scale;
+			const auto py = y * scale;
+			const auto lower = z < 0.0f;
+			folded[2 * i] = lower ? (1.0f - std::abs(py)) * std::copysign(1.0f, px) : px;
+			folded[2 * i + 1] = lower ? (1.0f - std::abs(px)) * std::copysign(1.0f, py) : py;
+		}
+	}
+
+	constexpr auto ENCODE_CHUNK = std::size_t{ 256 };
+
+	/**
+	 * Runs an encoder over count values in chunks small enough to convert on the stack, copying each chunk to target.
+	 * @param values - the source values, one float per encoded value.
+	 * @param count - the number of values.
+	 * @param target - where the encoded values go, tightly packed and not necessarily aligned.
+	 * @param convert - converts a chunk of values into an array of T.
+	 */
+	template <typename T, typename Converter>
+	void encodeChunked(const float* const values, const std::size_t count, std::byte* const target, Converter convert) {
+		T chunk[ENCODE_CHUNK];
+		for (auto i = std::size_t{ 0 }; i < count; i += ENCODE_CHUNK) {
+			const auto n = std::min(ENCODE_CHUNK, count - i);
+			convert(values + i, chunk, n);
+			std::memcpy(target + i * sizeof(T), chunk, n * sizeof(T));
+		}
+	}
+
+	// Packs four components as signed 10, 10, 10 and 2 bits, x in the least significant ones
+	std::uint32_t packInt2101010(const float* const values, const bool normalized) {
+		const auto component = [normalized](const float input, const int max) {
+			const auto value = input == input ? input : 0.0f;
+			const auto scaled = normalized ? std::clamp(value, -1.0f, 1.0f) * static_cast<float>(max) : value;
+			const auto rounded = static_cast<int>(std::lround(std::clamp(scaled, -max - 1.0f, static_cast<float>(max))));
+			return static_cast<std::uint32_t>(rounded);
+		};
+		return (component(values[0], 511) & 0x3FFu)
+			| (component(values[1], 511) & 0x3FFu) << 10
+			| (component(values[2], 511) & 0x3FFu) << 20
+			| (component(values[3], 1) & 0x3u) << 30;
+	}
+}
+
 VertexBuffer::Builder::Builder(const int bufferCount) {
 	_layout.reserve(bufferCount);
 	_layout.resize(bufferCount);
+	_packedSizes.resize(bufferCount);
 }
 
 VertexBuffer::Builder& VertexBuffer::Builder::vertexCount(const int count) {
@@ -30,20 +176,50 @@ VertexBuffer::Builder& VertexBuffer::Builder::attribute(
 	return *this;
 }
 
+VertexBuffer::Builder& VertexBuffer::Builder::attribute(
+	const int index,
+	const VertexAttribute attr,
+	const AttributeType type
+) {
+	// The stride stays 0 until build(), when the size of the whole vertex is known
+	_layout[index].emplace(attr, type, _packedSizes[index], 0);
+	_packedSizes[index] += resolveByteSize(type);
+	return *this;
+}
+
 VertexBuffer::Builder& VertexBuffer::Builder::normalized(const VertexAttribute attr) {
 	_normAttrs.insert(attr);
 	return *this;
 }
 
+VertexBuffer::Builder& VertexBuffer::Builder::usage(const Usage usage) {
+	_usage = usage;
+	return *this;
+}
+
 VertexBuffer* VertexBuffer::Builder::build(Engine& engine) {
+	// Resolve the stride of the interleaved attributes
+	for (std::size_t i = 0; i < _layout.size(); ++i) {
+		if (_packedSizes[i] == 0) {
+			continue;
+		}
+		auto layout = std::set<AttributeInfo>{};
+		for (const auto& [attr, type, byteOffset, byteStride] : _layout[i]) {
+			layout.emplace(attr, type, byteOffset, byteStride == 0 ? _packedSizes[i] : byteStride);
+		}
+		_layout[i] = std::move(layout);
+	}
+
 	const auto objects = new GLuint[_layout.size()];
 	glGenBuffers(static_cast<GLsizei>(_layout.size()), objects);
     const auto buffer = new VertexBuffer(
             objects,
             _vertexCount,
             std::move(_layout),
-            std::move(_normAttrs)
+            std::move(_normAttrs),
+            _usage
     );
+	buffer->allocate();
 	engine._vertexBuffers.insert(buffer);
 	return buffer;
 }
@@ -52,8 +228,39 @@ VertexBuffer::VertexBuffer(
 	GLuint* const bufferObjects,
 	const int vertexCount,
 	std::vector<std::set<AttributeInfo>>&& layout,
-	std::set<VertexAttribute>&& normAttrs
-) noexcept : _bufferObjects{ bufferObjects }, _vertexCount{ vertexCount }, _layout{ layout }, _normAttrs{ normAttrs } {}
+	std::set<VertexAttribute>&& normAttrs,
+	const Usage usage
+) noexcept : _bufferObjects{ bufferObjects }, _vertexCount{ vertexCount }, _layout{ layout }, _normAttrs{ normAttrs },
+	_usage{ usage } {}
+
+void VertexBuffer::allocate() {
+	if (_usage == Usage::STREAM) {
+		_streams.resize(_layout.size());
+	}
+
+	// Storage is immutable, so we size it once for good and only ever update its content afterward
+	for (auto i = 0; i < getBufferCount(); ++i) {
+		const auto regionSize = computeBufferByteSize(i);
+		glBindBuffer(GL_ARRAY_BUFFER, _bufferObjects[i]);
+
+		if (_usage == Usage::STATIC) {
+			glBufferStorage(GL_ARRAY_BUFFER, regionSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
+			continue;
+		}
+
+		// Coherent mapping makes our writes visible to the GPU without any explicit flush
+		constexpr auto flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, regionSize * REGION_COUNT, nullptr, flags);
+		const auto mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, regionSize * REGION_COUNT, flags);
+		if (!mapped) {
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			throw std::runtime_error("[VertexBuffer] \t- Could not map vertex buffer.");
+		}
+		_streams[i].mapped = static_cast<std::byte*>(mapped);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 
 GLuint VertexBuffer::getNativeObject() const {
 	return _bufferObjects[0];
@@ -67,43 +274,275 @@ int VertexBuffer::getBufferCount() const {
 	return static_cast<int>(_layout.size());
 }
 
-void VertexBuffer::setBufferAt(const int index, const void* const data) const {
-	const auto vertexSize = computeVertexByteSize(index);
+VertexBuffer::Usage VertexBuffer::getUsage() const {
+	return _usage;
+}
+
+void VertexBuffer::setBufferAt(const int index, const void* const data) {
+	const auto regionSize = static_cast<std::size_t>(computeBufferByteSize(index));
 
-	glBindBuffer(GL_ARRAY_BUFFER, _bufferObjects[index]);
+	if (_usage == Usage::STATIC) {
+		glBindBuffer(GL_ARRAY_BUFFER, _bufferObjects[index]);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(regionSize), data);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return;
+	}
 
-	// We transfer the data down the GPU by mean of std::mem copy.
-	// Create a dedicated memory region in the GPU.
-	glBufferStorage(
-		GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertexSize) * _vertexCount,
-		nullptr, GL_MAP_PERSISTENT_BIT | GL_MAP_WRITE_BIT
-	);
+	auto& stream = _streams[index];
+	if (stream.written) {
+		// Everything issued so far may read the current region, fence it off and move on to the next one
+		stream.fences[stream.region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		stream.region = (stream.region + 1) % REGION_COUNT;
 
-	// Acquire the pointer to the newly created memory.
-	const auto vertexData = glMapBufferRange(
-		GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(vertexSize) * _vertexCount,
-		GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT
-	);
-	if (!vertexData) {
-		throw std::runtime_error("[VertexBuffer] \t- Could not map vertex buffer.");
+		// Only blocks when the CPU runs a full ring ahead of the GPU
+		if (const auto fence = stream.fences[stream.region]) {
+			auto status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+			while (status == GL_TIMEOUT_EXPIRED) {
+				status = glClientWaitSync(fence, 0, FENCE_TIMEOUT);
+			}
+			if (status == GL_WAIT_FAILED) {
+				std::cerr << "[VertexBuffer] \t- Waiting on a stream region failed.\n";
+			}
+			glDeleteSync(fence);
+			stream.fences[stream.region] = nullptr;
+		}
 	}
 
-	// Transfer the vertex data.
-	std::memcpy(vertexData, data, static_cast<size_t>(vertexSize) * _vertexCount);
+	std::memcpy(stream.mapped + regionSize * stream.region, data, regionSize);
+	stream.written = true;
+}
 
-	// Finally we notify the GPU the change.
-	glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(vertexSize) * _vertexCount);
-	glUnmapBuffer(GL_ARRAY_BUFFER);
+GLintptr VertexBuffer::getRegionOffset(const int bufferIndex) const {
+	if (_usage == Usage::STATIC) {
+		return 0;
+	}
+	const auto regionSize = computeBufferByteSize(bufferIndex);
+	return regionSize * _streams[bufferIndex].region;
+}
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+void VertexBuffer::bindStreams() const {
+	for (auto i = 0; i < getBufferCount(); ++i) {
+		const auto regionOffset = getRegionOffset(i);
+		// Every attribute has a binding point of its own, matching its location
+		for (const auto& [attr, type, byteOffset, byteStride] : _layout[i]) {
+			glBindVertexBuffer(static_cast<GLuint>(attr), _bufferObjects[i], regionOffset + byteOffset, byteStride);
+		}
+	}
 }
 
-int VertexBuffer::computeVertexByteSize(const int bufferIndex) const {
-	auto byteSize = 0;
-	for (const auto stride : _layout[bufferIndex] |
-		std::views::transform([](const AttributeInfo& info) { return info.byteStride; })
-	) {
-		byteSize += stride;
+GLsizeiptr VertexBuffer::computeBufferByteSize(const int bufferIndex) const {
+	if (_vertexCount <= 0) {
+		return 0;
+	}
+	// The end of the last vertex of whichever attribute reaches the furthest, which works for single-attribute,
+	// interleaved and block-by-block layouts alike
+	auto byteSize = GLsizeiptr{ 0 };
+	for (const auto& [attr, type, byteOffset, byteStride] : _layout[bufferIndex]) {
+		const auto end = byteOffset + static_cast<GLsizeiptr>(byteStride) * (_vertexCount - 1) + resolveByteSize(type);
+		byteSize = std::max(byteSize, end);
 	}
 	return byteSize;
 }
+
+int VertexBuffer::resolveByteSize(const AttributeType type) {
+	switch (type) {
+	case AttributeType::UBYTE4:
+		return 4;
+	case AttributeType::FLOAT2:
+		return 2 * sizeof(float);
+	case AttributeType::FLOAT3:
+		return 3 * sizeof(float);
+	case AttributeType::FLOAT4:
+		return 4 * sizeof(float);
+	case AttributeType::UINT:
+		return sizeof(GLuint);
+	case AttributeType::HALF2:
+	case AttributeType::SHORT2:
+	case AttributeType::OCTAHEDRAL:
+		return 2 * sizeof(std::uint16_t);
+	case AttributeType::HALF4:
+	case AttributeType::SHORT4:
+		return 4 * sizeof(std::uint16_t);
+	case AttributeType::INT_2_10_10_10_REV:
+		return sizeof(std::uint32_t);
+	}
+	return 0;
+}
+
+int VertexBuffer::resolveComponentCount(const AttributeType type) {
+	switch (type) {
+	case AttributeType::UBYTE4:
+	case AttributeType::FLOAT4:
+	case AttributeType::HALF4:
+	case AttributeType::SHORT4:
+	case AttributeType::INT_2_10_10_10_REV:
+		return 4;
+	case AttributeType::FLOAT3:
+	case AttributeType::OCTAHEDRAL:
+		return 3;
+	case AttributeType::FLOAT2:
+	case AttributeType::HALF2:
+	case AttributeType::SHORT2:
+		return 2;
+	case AttributeType::UINT:
+		return 1;
+	}
+	return 0;
+}
+
+bool VertexBuffer::resolveNormalized(const AttributeType type, const bool requested) {
+	// The folded components of an octahedral vector only make sense in [-1, 1]
+	return requested || type == AttributeType::OCTAHEDRAL;
+}
+
+VertexBuffer::Packer::Packer(const Builder& builder, const int index) {
+	for (const auto& [attr, type, byteOffset, byteStride] : builder._layout[index]) {
+		_slots.emplace_back(attr, type, byteOffset, resolveNormalized(type, builder._normAttrs.contains(attr)));
+		// Interleaved attributes get their stride at build time, explicit ones already have it
+		_stride = byteStride == 0 ? builder._packedSizes[index] : std::max(_stride, byteStride);
+	}
+}
+
+VertexBuffer::Packer& VertexBuffer::Packer::vertex() {
+	++_vertexCount;
+	_data.resize(static_cast<std::size_t>(_vertexCount) * _stride);
+	return *this;
+}
+
+VertexBuffer::Packer& VertexBuffer::Packer::set(
+	const VertexAttribute attr, const float x, const float y, const float z, const float w
+) {
+	if (_vertexCount == 0) {
+		throw std::logic_error("[VertexBuffer] \t- Packer::vertex() must be called before setting attributes.");
+	}
+	const float values[]{ x, y, z, w };
+	const auto& slot = findSlot(attr);
+	encode(slot, values, 1, _data.data() + static_cast<std::size_t>(_vertexCount - 1) * _stride + slot.byteOffset);
+	return *this;
+}
+
+VertexBuffer::Packer& VertexBuffer::Packer::set(const VertexAttribute attr, const glm::vec2& value) {
+	return set(attr, value.x, value.y);
+}
+
+VertexBuffer::Packer& VertexBuffer::Packer::set(const VertexAttribute attr, const glm::vec3& value) {
+	return set(attr, value.x, value.y, value.z);
+}
+
+VertexBuffer::Packer& VertexBuffer::Packer::set(const VertexAttribute attr, const glm::vec4& value) {
+	return set(attr, value.x, value.y, value.z, value.w);
+}
+
+VertexBuffer::Packer& VertexBuffer::Packer::set(const VertexAttribute attr, const std::vector<float>& values) {
+	const auto& slot = findSlot(attr);
+	const auto components = static_cast<std::size_t>(resolveComponentCount(slot.type));
+	const auto count = static_cast<int>(values.size() / components);
+	if (count > _vertexCount) {
+		_vertexCount = count;
+		_data.resize(static_cast<std::size_t>(_vertexCount) * _stride);
+	}
+	// Encoding the whole run at once lets the conversions vectorize, the result is then spread over the vertices
+	const auto size = static_cast<std::size_t>(resolveByteSize(slot.type));
+	auto encoded = std::vector<std::byte>(size * count);
+	encode(slot, values.data(), count, encoded.data());
+	for (auto i = std::size_t{ 0 }; i < static_cast<std::size_t>(count); ++i) {
+		std::memcpy(_data.data() + i * _stride + slot.byteOffset, encoded.data() + i * size, size);
+	}
+	return *this;
+}
+
+int VertexBuffer::Packer::getVertexCount() const {
+	return _vertexCount;
+}
+
+int VertexBuffer::Packer::getStride() const {
+	return _stride;
+}
+
+const void* VertexBuffer::Packer::data() const {
+	return _data.data();
+}
+
+const void* VertexBuffer::Packer::data(const VertexAttribute attr) const {
+	return _data.data() + findSlot(attr).byteOffset;
+}
+
+const VertexBuffer::Packer::Slot& VertexBuffer::Packer::findSlot(const VertexAttribute attr) const {
+	const auto it = std::ranges::find(_slots, attr, &Slot::attr);
+	if (it == _slots.end()) {
+		throw std::invalid_argument("[VertexBuffer] \t- The packed buffer has no such attribute.");
+	}
+	return *it;
+}
+
+void VertexBuffer::Packer::encode(
+	const Slot& slot, const float* const values, const int count, std::byte* const target
+) {
+	const auto components = static_cast<std::size_t>(resolveComponentCount(slot.type));
+	const auto size = static_cast<std::size_t>(resolveByteSize(slot.type));
+	const auto n = static_cast<std::size_t>(count);
+	switch (slot.type) {
+	case AttributeType::FLOAT2:
+	case AttributeType::FLOAT3:
+	case AttributeType::FLOAT4:
+		std::memcpy(target, values, size * n);
+		break;
+	case AttributeType::UBYTE4:
+		// Normalized bytes map [0, 1] onto [0, 255], the others are taken as they come. NaNs become 0 since they
+		// survive std::clamp, and converting them is undefined.
+		encodeChunked<std::uint8_t>(
+			values, components * n, target,
+			[normalized = slot.normalized](const float* in, std::uint8_t* out, const std::size_t count) {
+				for (auto c = std::size_t{ 0 }; c < count; ++c) {
+					const auto number = in[c] == in[c] ? in[c] : 0.0f;
+					const auto value = normalized ? std::clamp(number, 0.0f, 1.0f) * 255.0f : number;
+					out[c] = static_cast<std::uint8_t>(std::clamp(value, 0.0f, 255.0f) + 0.5f);
+				}
+			}
+		);
+		break;
+	case AttributeType::UINT:
+		for (auto i = std::size_t{ 0 }; i < n; ++i) {
+			const auto value = static_cast<GLuint>(values[i]);
+			std::memcpy(target + i * size, &value, sizeof(value));
+		}
+		break;
+	case AttributeType::HALF2:
+	case AttributeType::HALF4:
+		encodeChunked<std::uint16_t>(values, components * n, target, encodeHalf);
+		break;
+	case AttributeType::SHORT2:
+	case AttributeType::SHORT4:
+		if (slot.normalized) {
+			encodeChunked<std::int16_t>(values, components * n, target, encodeSnorm16);
+		} else {
+			encodeChunked<std::int16_t>(
+				values, components * n, target,
+				[](const float* in, std::int16_t* out, const std::size_t count) {
+					for (auto c = std::size_t{ 0 }; c < count; ++c) {
+						const auto value = in[c] == in[c] ? in[c] : 0.0f;
+						out[c] = static_cast<std::int16_t>(std::lround(std::clamp(value, -32768.0f, 32767.0f)));
+					}
+				}
+			);
+		}
+		break;
+	case AttributeType::INT_2_10_10_10_REV:
+		for (auto i = std::size_t{ 0 }; i < n; ++i) {
+			const auto value = packInt2101010(values + i * components, slot.normalized);
+			std::memcpy(target + i * size, &value, sizeof(value));
+		}
+		break;
+	case AttributeType::OCTAHEDRAL:
+		// Three floats in, two shorts out, so the chunks are counted in vectors
+		for (auto i = std::size_t{ 0 }; i < n; i += ENCODE_CHUNK) {
+			const auto chunk = std::min(ENCODE_CHUNK, n - i);
+			float folded[2 * ENCODE_CHUNK];
+			std::int16_t shorts[2 * ENCODE_CHUNK];
+			encodeOctahedral(values + 3 * i, folded, chunk);
+			encodeSnorm16(folded, shorts, 2 * chunk);
+			std::memcpy(target + i * size, shorts, chunk * size);
+		}
+		break;
+	}
+}
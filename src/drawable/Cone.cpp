@@ -6,8 +6,6 @@
 #include <glm/vec3.hpp>
 #include <numbers>
 
-#include "IndexBuffer.h"
-#include "VertexBuffer.h"
 #include "RenderableManager.h"
 
 #include "drawable/Cone.h"
@@ -20,11 +18,12 @@ Cone::Builder& Cone::Builder::segments(const int segments) {
 	return *this;
 }
 
-std::unique_ptr<Drawable> Cone::Builder::build(Engine& engine) {
-    auto positions = std::vector<float>{};
-    auto colors = std::vector<float>{};
-    auto normals = std::vector<float>{};
-    auto texCoords = std::vector<float>{};
+Geometry Cone::Builder::generate() const {
+    auto geometry = Geometry{};
+    auto& positions = geometry.positions;
+    auto& colors = geometry.colors;
+    auto& normals = geometry.normals;
+    auto& texCoords = geometry.uvs;
 
     const auto baseCenter = glm::vec3{ 0.0f, 0.0f, -1.0f };
     const auto up = glm::vec3{ 0.0f, 0.0f, 1.0f };
@@ -88,39 +87,16 @@ std::unique_ptr<Drawable> Cone::Builder::build(Engine& engine) {
         sideIndices.push_back(i + _segments + 1);
 	}
 
-	constexpr auto floatSize = 4;
-	const auto vertexBuffer = VertexBuffer::Builder(4)
-		.vertexCount(vertexCount)
-		.attribute(0, VertexBuffer::VertexAttribute::POSITION, VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.attribute(1, VertexBuffer::VertexAttribute::COLOR, VertexBuffer::AttributeType::FLOAT4, 0, floatSize * 4)
-		.attribute(2, VertexBuffer::VertexAttribute::NORMAL, VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-        .attribute(3, VertexBuffer::VertexAttribute::UV0, VertexBuffer::AttributeType::FLOAT2, 0, floatSize * 2)
-        .build(engine);
-	vertexBuffer->setBufferAt(0, positions.data());
-	vertexBuffer->setBufferAt(1, colors.data());
-    vertexBuffer->setBufferAt(2, normals.data());
-    vertexBuffer->setBufferAt(3, texCoords.data());
-
-	const auto baseIdxBuff = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(baseIndices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	baseIdxBuff->setBuffer(baseIndices.data());
-
-	const auto sideIdxBuff = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(sideIndices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	sideIdxBuff->setBuffer(sideIndices.data());
+	geometry.addPart(RenderableManager::PrimitiveType::TRIANGLE_FAN, baseIndices);
+	geometry.addPart(RenderableManager::PrimitiveType::TRIANGLES, sideIndices);
+	return geometry;
+}
 
+std::unique_ptr<Drawable> Cone::Builder::build(Engine& engine) {
+	const auto geometry = generate();
 	const auto shader = defaultShader(engine);
 	const auto entity = EntityManager::get()->create();
-	RenderableManager::Builder(2)
-		.geometry(0, RenderableManager::PrimitiveType::TRIANGLE_FAN, *vertexBuffer, *baseIdxBuff, static_cast<int>(baseIndices.size()), 0)
-		.shader(0, shader)
-		.geometry(1, RenderableManager::PrimitiveType::TRIANGLES, *vertexBuffer, *sideIdxBuff, static_cast<int>(sideIndices.size()), 0)
-		.shader(1, shader)
-		.build(entity);
+	upload(engine, geometry, shader).build(entity);
 
 	return std::unique_ptr<Drawable>(new Cone(entity, shader));
 }
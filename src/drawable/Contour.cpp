@@ -1,8 +1,6 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
-#include "IndexBuffer.h"
-#include "VertexBuffer.h"
 #include "RenderableManager.h"
 
 #include "drawable/Contour.h"
@@ -18,19 +16,23 @@ Contour::Builder &Contour::Builder::high(const float hi) {
     return *this;
 }
 
-std::unique_ptr<Drawable> Contour::Builder::build(Engine &engine) {
-    auto positions = std::vector<float>{};
-    auto colors = std::vector<float>{};
+Geometry Contour::Builder::generate() const {
+    auto geometry = Geometry{};
+    auto& positions = geometry.positions;
+    auto& colors = geometry.colors;
 
     const auto xStep = _halfExtentX * 2 / static_cast<float>(_segmentsX);
     const auto yStep = _halfExtentY * 2 / static_cast<float>(_segmentsY);
 
+    const auto heights = sampleHeights();
+    const auto columnSize = getPaddedColumnSize();
+
     for (auto i = 0; i < _segmentsX + 1; ++i) {
         for (auto j = 0; j < _segmentsY + 1; ++j) {
             // Acquire the x, y coordinate
             const auto x0 = static_cast<float>(i) * xStep - _halfExtentX;	// from top left
             const auto y0 = _halfExtentY - static_cast<float>(j) * yStep;	// to bottom right
-            const auto z0 = _func(x0, y0);
+            const auto z0 = heights[static_cast<std::size_t>(i + 1) * columnSize + j + 1];
 
             positions.push_back(x0); positions.push_back(y0); positions.push_back(0.0f);
 
@@ -40,40 +42,17 @@ std::unique_ptr<Drawable> Contour::Builder::build(Engine &engine) {
         }
     }
 
-    constexpr auto floatSize = 4;
-    const auto vertexBuffer = VertexBuffer::Builder(2)
-            .vertexCount(static_cast<int>(positions.size() / 3))
-            .attribute(0, VertexBuffer::VertexAttribute::POSITION, VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-            .attribute(1, VertexBuffer::VertexAttribute::COLOR, VertexBuffer::AttributeType::FLOAT4, 0, floatSize * 4)
-            .build(engine);
-    vertexBuffer->setBufferAt(0, positions.data());
-    vertexBuffer->setBufferAt(1, colors.data());
+    addStrips(geometry);
+    return geometry;
+}
+
+std::unique_ptr<Drawable> Contour::Builder::build(Engine &engine) {
+    const auto geometry = generate();
 
     shaderModel(Shader::Model::UNLIT);
     const auto shader = defaultShader(engine);
     const auto entity = EntityManager::get()->create();
-
-    auto renderableBuilder = RenderableManager::Builder(_segmentsY);
-
-    for (auto i = 0; i < _segmentsY; ++i) {
-        auto indices = std::vector<unsigned>{};
-        // for each column pair of vertices starting at the least x
-        for (auto j = 0; j < _segmentsX + 1; ++j) {
-            indices.push_back(j + i * (_segmentsX + 1));
-            indices.push_back(j + (i + 1) * (_segmentsX + 1));
-        }
-
-        const auto indexBuffer = IndexBuffer::Builder()
-                .indexCount(static_cast<int>(indices.size()))
-                .indexType(IndexBuffer::Builder::IndexType::UINT)
-                .build(engine);
-        indexBuffer->setBuffer(indices.data());
-
-        renderableBuilder
-            .geometry(i, RenderableManager::PrimitiveType::TRIANGLE_STRIP, *vertexBuffer, *indexBuffer,static_cast<int>(indices.size()), 0)
-            .shader(i, shader);
-    }
-    renderableBuilder.build(entity);
+    upload(engine, geometry, shader).build(entity);
 
     return std::unique_ptr<Drawable>(new Contour(entity, shader));
 }
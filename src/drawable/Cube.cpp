@@ -3,15 +3,14 @@
 
 #include <vector>
 
-#include "VertexBuffer.h"
-#include "IndexBuffer.h"
 #include "RenderableManager.h"
 
 #include "drawable/Cube.h"
 #include "drawable/Color.h"
 
-std::unique_ptr<Drawable> Cube::Builder::build(Engine& engine) {
-	const auto positions = std::vector{
+Geometry Cube::Builder::generate() const {
+	auto geometry = Geometry{};
+	geometry.positions = std::vector{
 		// Face +X
 		 1.0f, -1.0f,  1.0f,
 		 1.0f, -1.0f, -1.0f,
@@ -44,7 +43,7 @@ std::unique_ptr<Drawable> Cube::Builder::build(Engine& engine) {
 		-1.0f, -1.0f, -1.0f,
 	};
 
-	const auto normals = std::vector{
+	geometry.normals = std::vector{
 		// Face +X
 		 1.0f,  0.0f,  0.0f,
 		 1.0f,  0.0f,  0.0f,
@@ -77,7 +76,7 @@ std::unique_ptr<Drawable> Cube::Builder::build(Engine& engine) {
 		 0.0f,  0.0f, -1.0f,
 	};
 
-    const auto texCoords = std::vector{
+    geometry.uvs = std::vector{
         0.0f, 0.0f,
         0.0f, 1.0f,
         1.0f, 0.0f,
@@ -109,7 +108,7 @@ std::unique_ptr<Drawable> Cube::Builder::build(Engine& engine) {
         1.0f, 1.0f,
     };
 
-	const auto colors = std::vector{
+	geometry.colors = std::vector{
 		// Face X+
 		srgb::BLUE[0],		srgb::BLUE[1],		srgb::BLUE[2],	  1.0f,
 		srgb::BLACK[0],		srgb::BLACK[1],		srgb::BLACK[2],	  1.0f,
@@ -149,31 +148,15 @@ std::unique_ptr<Drawable> Cube::Builder::build(Engine& engine) {
 		indices.push_back(it + 2); indices.push_back(it + 1); indices.push_back(it + 3);
 	}
 
-	constexpr auto floatSize = 4;
-	const auto vertexBuffer = VertexBuffer::Builder(4)
-		.vertexCount(static_cast<int>(positions.size() / 3))
-		.attribute(0, VertexBuffer::VertexAttribute::POSITION,VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.attribute(1, VertexBuffer::VertexAttribute::COLOR,VertexBuffer::AttributeType::FLOAT4, 0, floatSize * 4)
-		.attribute(2, VertexBuffer::VertexAttribute::NORMAL,VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-        .attribute(3, VertexBuffer::VertexAttribute::UV0, VertexBuffer::AttributeType::FLOAT2, 0, floatSize * 2)
-		.build(engine);
-	vertexBuffer->setBufferAt(0, positions.data());
-	vertexBuffer->setBufferAt(1, colors.data());
-	vertexBuffer->setBufferAt(2, normals.data());
-    vertexBuffer->setBufferAt(3, texCoords.data());
-
-	const auto indexBuffer = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(indices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	indexBuffer->setBuffer(indices.data());
+	geometry.addPart(RenderableManager::PrimitiveType::TRIANGLES, indices);
+	return geometry;
+}
 
+std::unique_ptr<Drawable> Cube::Builder::build(Engine& engine) {
+	const auto geometry = generate();
 	const auto shader = defaultShader(engine);
 	const auto entity = EntityManager::get()->create();
-	RenderableManager::Builder(1)
-		.geometry(0, RenderableManager::PrimitiveType::TRIANGLES, *vertexBuffer, *indexBuffer,static_cast<int>(indices.size()), 0)
-		.shader(0, shader)
-		.build(entity);
-	
+	upload(engine, geometry, shader).build(entity);
+
 	return std::unique_ptr<Drawable>(new Cube(entity, shader));
 }
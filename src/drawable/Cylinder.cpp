@@ -6,8 +6,6 @@
 #include <numbers>
 #include <vector>
 
-#include "IndexBuffer.h"
-#include "VertexBuffer.h"
 #include "RenderableManager.h"
 
 #include "drawable/Cylinder.h"
@@ -20,11 +18,12 @@ Cylinder::Builder& Cylinder::Builder::segments(const int segments) {
 	return *this;
 }
 
-std::unique_ptr<Drawable> Cylinder::Builder::build(Engine& engine) {
-	auto positions = std::vector<float>{};
-	auto colors = std::vector<float>{};
-    auto normals = std::vector<float>{};
-    auto texCoords = std::vector<float>{};
+Geometry Cylinder::Builder::generate() const {
+	auto geometry = Geometry{};
+	auto& positions = geometry.positions;
+	auto& colors = geometry.colors;
+    auto& normals = geometry.normals;
+    auto& texCoords = geometry.uvs;
 
 	const auto up = glm::vec3{ 0.0f, 0.0f, 1.0f };
 
@@ -96,47 +95,17 @@ std::unique_ptr<Drawable> Cylinder::Builder::build(Engine& engine) {
 		sideIndices.push_back(i + 1 + 2 * (_segments + 1));
 	}
 
-	constexpr auto floatSize = 4;
-	const auto vertexBuffer = VertexBuffer::Builder(4)
-		.vertexCount(vertexCount)
-		.attribute(0, VertexBuffer::VertexAttribute::POSITION, VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.attribute(1, VertexBuffer::VertexAttribute::COLOR, VertexBuffer::AttributeType::FLOAT4, 0, floatSize * 4)
-		.attribute(2, VertexBuffer::VertexAttribute::NORMAL, VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-        .attribute(3, VertexBuffer::VertexAttribute::UV0, VertexBuffer::AttributeType::FLOAT2, 0, floatSize * 2)
-        .build(engine);
-	vertexBuffer->setBufferAt(0, positions.data());
-	vertexBuffer->setBufferAt(1, colors.data());
-    vertexBuffer->setBufferAt(2, normals.data());
-    vertexBuffer->setBufferAt(3, texCoords.data());
-
-	const auto topBuffer = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(topIndices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	topBuffer->setBuffer(topIndices.data());
-
-	const auto botBuffer = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(botIndices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	botBuffer->setBuffer(botIndices.data());
-
-	const auto sideBuffer = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(sideIndices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	sideBuffer->setBuffer(sideIndices.data());
+	geometry.addPart(RenderableManager::PrimitiveType::TRIANGLE_STRIP, sideIndices);
+	geometry.addPart(RenderableManager::PrimitiveType::TRIANGLE_FAN, topIndices);
+	geometry.addPart(RenderableManager::PrimitiveType::TRIANGLE_FAN, botIndices);
+	return geometry;
+}
 
+std::unique_ptr<Drawable> Cylinder::Builder::build(Engine& engine) {
+	const auto geometry = generate();
 	const auto shader = defaultShader(engine);
     const auto entity = EntityManager::get()->create();
-	RenderableManager::Builder(3)
-		.geometry(0, RenderableManager::PrimitiveType::TRIANGLE_STRIP, *vertexBuffer, *sideBuffer,static_cast<int>(sideIndices.size()), 0)
-		.shader(0, shader)
-		.geometry(1, RenderableManager::PrimitiveType::TRIANGLE_FAN, *vertexBuffer, *topBuffer,static_cast<int>(topIndices.size()), 0)
-		.shader(1, shader)
-		.geometry(2, RenderableManager::PrimitiveType::TRIANGLE_FAN, *vertexBuffer, *botBuffer,static_cast<int>(botIndices.size()), 0)
-		.shader(2, shader)
-		.build(entity);
+	upload(engine, geometry, shader).build(entity);
 
 	return std::unique_ptr<Drawable>(new Cylinder(entity, shader));
 }
@@ -1,6 +1,11 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <algorithm>
+#include <limits>
+
+#include "IndexBuffer.h"
+
 #include "drawable/Drawable.h"
 
 Entity Drawable::getEntity() const {
@@ -11,15 +16,24 @@ Shader* Drawable::getShader() const {
 	return _shader;
 }
 
-Shader *Drawable::Builder::defaultShader(Engine& engine) const {
-    const auto shader = Shader::Builder(_shaderModel).build(engine);
+Shader *Drawable::Builder::defaultShader(Engine& engine, const std::initializer_list<Shader::Feature> features) const {
+    auto builder = Shader::Builder(_shaderModel);
+    for (const auto feature : features) {
+        builder.feature(feature);
+    }
+    const auto textured = _shaderModel == Shader::Model::UNLIT
+        ? _textureUnlit != nullptr
+        : _textureDiffuse != nullptr || _textureSpecular != nullptr;
+    if (textured) {
+        builder.feature(Shader::Feature::TEXTURED);
+    }
+
+    const auto shader = builder.build(engine);
     if (_shaderModel == Shader::Model::UNLIT) {
         if (_textureUnlit != nullptr) {
-            shader->use();
             shader->setUniform(Shader::Uniform::UNLIT_TEXTURE, *_textureUnlit);
         }
     } else if (_shaderModel == Shader::Model::PHONG) {
-        shader->use();
         shader->setUniform(Shader::Uniform::MATERIAL_AMBIENT, _phongAmbient.r, _phongAmbient.g, _phongAmbient.b);
         shader->setUniform(Shader::Uniform::MATERIAL_DIFFUSE, _phongDiffuse.r, _phongDiffuse.g, _phongDiffuse.b);
         shader->setUniform(Shader::Uniform::MATERIAL_SPECULAR, _phongSpecular.r, _phongSpecular.g, _phongSpecular.b);
@@ -100,3 +114,69 @@ Drawable::Builder &Drawable::Builder::textureShininess(const float shininess) {
     _textureShininess = shininess;
     return *this;
 }
+
+VertexBuffer* Drawable::Builder::uploadVertices(Engine& engine, const Geometry& geometry) {
+    auto vertexBufferBuilder = VertexBuffer::Builder(1);
+    vertexBufferBuilder.attribute(0, VertexBuffer::VertexAttribute::POSITION, VertexBuffer::AttributeType::FLOAT3);
+    if (!geometry.colors.empty()) {
+        vertexBufferBuilder.attribute(0, VertexBuffer::VertexAttribute::COLOR, VertexBuffer::AttributeType::FLOAT4);
+    }
+    if (!geometry.normals.empty()) {
+        vertexBufferBuilder.attribute(0, VertexBuffer::VertexAttribute::NORMAL, VertexBuffer::AttributeType::FLOAT3);
+    }
+    if (!geometry.uvs.empty()) {
+        vertexBufferBuilder.attribute(0, VertexBuffer::VertexAttribute::UV0, VertexBuffer::AttributeType::FLOAT2);
+    }
+
+    auto vertices = VertexBuffer::Packer(vertexBufferBuilder, 0);
+    vertices.set(VertexBuffer::VertexAttribute::POSITION, geometry.positions);
+    if (!geometry.colors.empty()) {
+        vertices.set(VertexBuffer::VertexAttribute::COLOR, geometry.colors);
+    }
+    if (!geometry.normals.empty()) {
+        vertices.set(VertexBuffer::VertexAttribute::NORMAL, geometry.normals);
+    }
+    if (!geometry.uvs.empty()) {
+        vertices.set(VertexBuffer::VertexAttribute::UV0, geometry.uvs);
+    }
+
+    const auto vertexBuffer = vertexBufferBuilder
+        .vertexCount(vertices.getVertexCount())
+        .build(engine);
+    vertexBuffer->setBufferAt(0, vertices.data());
+    return vertexBuffer;
+}
+
+RenderableManager::Builder Drawable::Builder::uploadParts(
+    Engine& engine, const Geometry& geometry, const VertexBuffer& vertices, Shader* const shader
+) {
+    // Parts index relative to their base vertex, so the largest index rather than the vertex count decides the type
+    constexpr auto restart = std::numeric_limits<unsigned>::max();
+    auto largest = 0u;
+    for (const auto index : geometry.indices) {
+        if (index != restart) {
+            largest = std::max(largest, index);
+        }
+    }
+
+    const auto indexBuffer = IndexBuffer::Builder()
+        .indexCount(static_cast<int>(geometry.indices.size()))
+        .fitIndexType(static_cast<int>(std::min<unsigned>(largest, std::numeric_limits<int>::max() - 1)) + 1)
+        .build(engine);
+    indexBuffer->setBuffer(geometry.indices.data());
+
+    const auto partCount = static_cast<int>(geometry.parts.size());
+    auto renderableBuilder = RenderableManager::Builder(partCount);
+    for (auto i = 0; i < partCount; ++i) {
+        const auto& part = geometry.parts[i];
+        renderableBuilder
+            .geometry(i, part.topology, vertices, *indexBuffer, part.count, part.offset, part.baseVertex)
+            .shader(i, shader);
+    }
+    renderableBuilder.boundingBox(geometry.positions);
+    return renderableBuilder;
+}
+
+RenderableManager::Builder Drawable::Builder::upload(Engine& engine, const Geometry& geometry, Shader* const shader) {
+    return uploadParts(engine, geometry, *uploadVertices(engine, geometry), shader);
+}
@@ -11,8 +11,9 @@
 using namespace srgb;
 using namespace glm;
 
-std::unique_ptr<Drawable> Frustum::Builder::build(Engine& engine) {
-    const auto positions = std::vector{
+Geometry Frustum::Builder::generate() const {
+    auto geometry = Geometry{};
+    geometry.positions = std::vector{
         // Face +X
          0.5f, -0.5f,  1.0f,
          1.0f, -1.0f, -1.0f,
@@ -50,7 +51,7 @@ std::unique_ptr<Drawable> Frustum::Builder::build(Engine& engine) {
     const auto xnNorm = normalize(cross(vec3{  0.0f, -1.0f, 0.0f }, vec3{  0.5f,  0.0f, 1.0f }));
     const auto ypNorm = normalize(cross(vec3{ -1.0f,  0.0f, 0.0f }, vec3{  0.0f, -0.5f, 1.0f }));
     const auto ynNorm = normalize(cross(vec3{  1.0f,  0.0f, 0.0f }, vec3{  0.0f,  0.5f, 1.0f }));
-    const auto normals = std::vector{
+    geometry.normals = std::vector{
         // Face +X
         xpNorm.x, xpNorm.y, xpNorm.z,
         xpNorm.x, xpNorm.y, xpNorm.z,
@@ -83,7 +84,7 @@ std::unique_ptr<Drawable> Frustum::Builder::build(Engine& engine) {
          0.0f,  0.0f, -1.0f,
     };
 
-    const auto colors = std::vector{
+    geometry.colors = std::vector{
         // Face X+
         BLUE[0],     BLUE[1],     BLUE[2],     1.0f,
         BLACK[0],    BLACK[1],    BLACK[2],    1.0f,
@@ -116,7 +117,7 @@ std::unique_ptr<Drawable> Frustum::Builder::build(Engine& engine) {
         RED[0],      RED[1],      RED[2],      1.0f,
     };
 
-    const auto texCoords = std::vector{
+    geometry.uvs = std::vector{
         // Face +X
         0.25f, 0.0f,
         0.0f, 1.0f,
@@ -156,31 +157,15 @@ std::unique_ptr<Drawable> Frustum::Builder::build(Engine& engine) {
         indices.push_back(it + 2); indices.push_back(it + 1); indices.push_back(it + 3);
     }
 
-	constexpr auto floatSize = 4;
-	const auto vertexBuffer = VertexBuffer::Builder(4)
-		.vertexCount(static_cast<int>(positions.size() / 3))
-		.attribute(0, VertexBuffer::VertexAttribute::POSITION,VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.attribute(1, VertexBuffer::VertexAttribute::COLOR,VertexBuffer::AttributeType::FLOAT4, 0, floatSize * 4)
-		.attribute(2, VertexBuffer::VertexAttribute::NORMAL, VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-        .attribute(3, VertexBuffer::VertexAttribute::UV0, VertexBuffer::AttributeType::FLOAT2, 0, floatSize * 2)
-        .build(engine);
-	vertexBuffer->setBufferAt(0, positions.data());
-	vertexBuffer->setBufferAt(1, colors.data());
-    vertexBuffer->setBufferAt(2, normals.data());
-    vertexBuffer->setBufferAt(3, texCoords.data());
-
-	const auto indexBuffer = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(indices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	indexBuffer->setBuffer(indices.data());
+    geometry.addPart(RenderableManager::PrimitiveType::TRIANGLES, indices);
+    return geometry;
+}
 
+std::unique_ptr<Drawable> Frustum::Builder::build(Engine& engine) {
+    const auto geometry = generate();
 	const auto shader = defaultShader(engine);
     const auto entity = EntityManager::get()->create();
-    RenderableManager::Builder(1)
-            .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, *vertexBuffer, *indexBuffer,static_cast<int>(indices.size()), 0)
-            .shader(0, shader)
-            .build(entity);
+    upload(engine, geometry, shader).build(entity);
 
 	return std::unique_ptr<Drawable>(new Frustum(entity, shader));
 }
\ No newline at end of file
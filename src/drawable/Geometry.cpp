@@ -0,0 +1,15 @@
+// Copyright (c) 2023. Minh Nguyen
+// All rights reserved.
+
+#include "drawable/Geometry.h"
+
+void Geometry::addPart(
+	const RenderableManager::PrimitiveType topology, const std::vector<unsigned>& partIndices, const int baseVertex
+) {
+	parts.push_back({ topology, static_cast<int>(partIndices.size()), static_cast<int>(indices.size()), baseVertex });
+	indices.insert(indices.end(), partIndices.begin(), partIndices.end());
+}
+
+int Geometry::getVertexCount() const {
+	return static_cast<int>(positions.size() / 3);
+}
@@ -1,7 +1,10 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <algorithm>
 #include <glm/geometric.hpp>
+#include <limits>
+#include <span>
 #include <vector>
 
 #include "IndexBuffer.h"
@@ -11,6 +14,8 @@
 #include "drawable/Mesh.h"
 #include "drawable/Color.h"
 
+#include "utils/ThreadPool.h"
+
 Mesh::Builder& Mesh::Builder::halfExtentX(const float extent) {
 	_halfExtentX = extent;
 	if (_halfExtentX < MIN_EXTENT) {
@@ -51,114 +56,158 @@ Mesh::Builder& Mesh::Builder::segments(const int segments) {
 	return segmentsX(segments).segmentsY(segments);
 }
 
-std::unique_ptr<Drawable> Mesh::Builder::build(Engine& engine) {
-	auto positions = std::vector<float>{};
-	auto colors = std::vector<float>{};
-	auto normals = std::vector<float>{};
-    auto texCoords = std::vector<float>{};
+Mesh::Builder& Mesh::Builder::batchFunction(BatchFunction func) {
+	_batchFunc = std::move(func);
+	return *this;
+}
 
+Geometry Mesh::Builder::generate() const {
 	const auto xStep = _halfExtentX * 2 / static_cast<float>(_segmentsX);
 	const auto yStep = _halfExtentY * 2 / static_cast<float>(_segmentsY);
 
-	for (auto i = 0; i < _segmentsX + 1; ++i) {
-		for (auto j = 0; j < _segmentsY + 1; ++j) {
-			// Acquire the x, y coordinate
-			const auto x0 = static_cast<float>(i) * xStep - _halfExtentX;	// from top left
-			const auto y0 = _halfExtentY - static_cast<float>(j) * yStep;	// to bottom right
-			// Evaluate z, could be a NaN, but let's view it as a feature
-			const auto z0 = _func(x0, y0);
-
-			positions.push_back(x0); positions.push_back(y0); positions.push_back(z0);
-
-			// Determine the normals
-			const auto x1 = static_cast<float>(i + 1) * xStep - _halfExtentX;
-			const auto y1 = y0;
-			const auto z1 = _func(x1, y1);
-
-			const auto x2 = x0;
-			const auto y2 = _halfExtentY - static_cast<float>(j + 1) * yStep;
-			const auto z2 = _func(x2, y2);
-
-			const auto x3 = static_cast<float>(i - 1) * xStep - _halfExtentX;
-			const auto y3 = y2;
-			const auto z3 = _func(x3, y3);
-
-			const auto x4 = static_cast<float>(i - 1) * xStep - _halfExtentX;
-			const auto y4 = y0;
-			const auto z4 = _func(x4, y4);
-
-			const auto x5 = x0;
-			const auto y5 = _halfExtentY - static_cast<float>(j - 1) * yStep;
-			const auto z5 = _func(x5, y5);
-
-			const auto x6 = static_cast<float>(i + 1) * xStep - _halfExtentX;
-			const auto y6 = y5;
-			const auto z6 = _func(x6, y6);
-
-			const auto vec01 = glm::vec3{ x1 - x0, y1 - y0, z1 - z0 };
-			const auto vec02 = glm::vec3{ x2 - x0, y2 - y0, z2 - z0 };
-			const auto vec03 = glm::vec3{ x3 - x0, y3 - y0, z3 - z0 };
-			const auto vec04 = glm::vec3{ x4 - x0, y4 - y0, z4 - z0 };
-			const auto vec05 = glm::vec3{ x5 - x0, y5 - y0, z5 - z0 };
-			const auto vec06 = glm::vec3{ x6 - x0, y6 - y0, z6 - z0 };
-
-			const auto norm1 = normalize(cross(vec01, vec06));
-			const auto norm2 = normalize(cross(vec02, vec01));
-			const auto norm3 = normalize(cross(vec03, vec02));
-			const auto norm4 = normalize(cross(vec04, vec03));
-			const auto norm5 = normalize(cross(vec05, vec04));
-			const auto norm6 = normalize(cross(vec06, vec05));
-
-			const auto normal = (norm1 + norm2 + norm3 + norm4 + norm5 + norm6) / 6.0f;
-			normals.push_back(normal.x); normals.push_back(normal.y); normals.push_back(normal.z);
-
-			const auto rgb = srgb::heatColorAt(z0);
-			colors.push_back(rgb[0]); colors.push_back(rgb[1]);
-			colors.push_back(rgb[2]); colors.push_back(1.0f);
-
-            const auto u = static_cast<float>(i) / static_cast<float>(_segmentsX);
-            const auto v = static_cast<float>(j) / static_cast<float>(_segmentsY);
-            texCoords.push_back(u); texCoords.push_back(v);
+	const auto heights = sampleHeights();
+	const auto columnSize = getPaddedColumnSize();
+	const auto heightAt = [&heights, columnSize](const int i, const int j) {
+		return heights[static_cast<std::size_t>(i + 1) * columnSize + j + 1];
+	};
+
+	const auto vertexCount = static_cast<std::size_t>(_segmentsX + 1) * (_segmentsY + 1);
+	auto geometry = Geometry{};
+	auto& positions = geometry.positions;
+	auto& normals = geometry.normals;
+	auto& colors = geometry.colors;
+	auto& uvs = geometry.uvs;
+	positions.resize(3 * vertexCount);
+	normals.resize(3 * vertexCount);
+	colors.resize(4 * vertexCount);
+	uvs.resize(2 * vertexCount);
+
+	ThreadPool::get()->parallelFor(0, _segmentsX + 1, [&](const int first, const int last) {
+		for (auto i = first; i < last; ++i) {
+			for (auto j = 0; j < _segmentsY + 1; ++j) {
+				const auto vertex = static_cast<std::size_t>(i) * (_segmentsY + 1) + j;
+				// From top left to bottom right, z could be a NaN, but let's view it as a feature
+				const auto x = static_cast<float>(i) * xStep - _halfExtentX;
+				const auto y = _halfExtentY - static_cast<float>(j) * yStep;
+				const auto z = heightAt(i, j);
+				positions[3 * vertex] = x;
+				positions[3 * vertex + 1] = y;
+				positions[3 * vertex + 2] = z;
+
+				// Central differences, y decreases as j increases
+				const auto dzdx = (heightAt(i + 1, j) - heightAt(i - 1, j)) / (2.0f * xStep);
+				const auto dzdy = (heightAt(i, j - 1) - heightAt(i, j + 1)) / (2.0f * yStep);
+				const auto normal = glm::normalize(glm::vec3{ -dzdx, -dzdy, 1.0f });
+				normals[3 * vertex] = normal.x;
+				normals[3 * vertex + 1] = normal.y;
+				normals[3 * vertex + 2] = normal.z;
+
+				const auto rgb = srgb::heatColorAt(z);
+				colors[4 * vertex] = rgb[0];
+				colors[4 * vertex + 1] = rgb[1];
+				colors[4 * vertex + 2] = rgb[2];
+				colors[4 * vertex + 3] = 1.0f;
+
+				uvs[2 * vertex] = static_cast<float>(i) / static_cast<float>(_segmentsX);
+				uvs[2 * vertex + 1] = static_cast<float>(j) / static_cast<float>(_segmentsY);
+			}
 		}
-	}
+	});
 
-	constexpr auto floatSize = 4;
-	const auto vertexBuffer = VertexBuffer::Builder(4)
-		.vertexCount(static_cast<int>(positions.size() / 3))
-		.attribute(0, VertexBuffer::VertexAttribute::POSITION, VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.attribute(1, VertexBuffer::VertexAttribute::COLOR, VertexBuffer::AttributeType::FLOAT4, 0, floatSize * 4)
-		.attribute(2, VertexBuffer::VertexAttribute::NORMAL, VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.attribute(3, VertexBuffer::VertexAttribute::UV0, VertexBuffer::AttributeType::FLOAT2, 0 , floatSize * 2)
+	addStrips(geometry);
+	return geometry;
+}
+
+std::unique_ptr<Drawable> Mesh::Builder::build(Engine& engine) {
+	const auto geometry = generate();
+
+	// All attributes go interleaved into a single buffer. Positions keep full floats since heights can span any range,
+	// the rest is compacted to 24 bytes per vertex instead of 48.
+	auto vertexBufferBuilder = VertexBuffer::Builder(1);
+	vertexBufferBuilder
+		.attribute(0, VertexBuffer::VertexAttribute::POSITION, VertexBuffer::AttributeType::FLOAT3)
+		.attribute(0, VertexBuffer::VertexAttribute::COLOR, VertexBuffer::AttributeType::UBYTE4)
+		.attribute(0, VertexBuffer::VertexAttribute::NORMAL, VertexBuffer::AttributeType::OCTAHEDRAL)
+		.attribute(0, VertexBuffer::VertexAttribute::UV0, VertexBuffer::AttributeType::HALF2)
+		.normalized(VertexBuffer::VertexAttribute::COLOR);
+	auto vertices = VertexBuffer::Packer(vertexBufferBuilder, 0);
+	vertices
+		.set(VertexBuffer::VertexAttribute::POSITION, geometry.positions)
+		.set(VertexBuffer::VertexAttribute::NORMAL, geometry.normals)
+		.set(VertexBuffer::VertexAttribute::COLOR, geometry.colors)
+		.set(VertexBuffer::VertexAttribute::UV0, geometry.uvs);
+
+	const auto vertexBuffer = vertexBufferBuilder
+		.vertexCount(vertices.getVertexCount())
         .build(engine);
-	vertexBuffer->setBufferAt(0, positions.data());
-	vertexBuffer->setBufferAt(1, colors.data());
-	vertexBuffer->setBufferAt(2, normals.data());
-    vertexBuffer->setBufferAt(3, texCoords.data());
+	vertexBuffer->setBufferAt(0, vertices.data());
 
-	const auto shader = defaultShader(engine);
+	const auto shader = defaultShader(engine, { Shader::Feature::OCTAHEDRAL_NORMALS });
 	const auto entity = EntityManager::get()->create();
+	uploadParts(engine, geometry, *vertexBuffer, shader).build(entity);
 
-	auto renderableBuilder = RenderableManager::Builder(_segmentsY);
+	return std::unique_ptr<Drawable>(new Mesh(entity, shader));
+}
 
-	for (auto i = 0; i < _segmentsY; ++i) {
-		auto indices = std::vector<unsigned>{};
-		// for each column pair of vertices starting at the least x
-		for (auto j = 0; j < _segmentsX + 1; ++j) {
-			indices.push_back(j + i * (_segmentsX + 1));
-			indices.push_back(j + (i + 1) * (_segmentsX + 1));
+void Mesh::Builder::addStrips(Geometry& geometry) const {
+	// Matches GL_PRIMITIVE_RESTART_FIXED_INDEX for unsigned int indices, setBuffer() converts it for 16-bit ones
+	constexpr auto restart = std::numeric_limits<unsigned>::max();
+	const auto column = _segmentsY + 1;
+
+	// A band of n strips spans n + 1 columns, fall back to a single band of 32-bit indices if not even one fits
+	const auto stripsPerBand = std::max(IndexBuffer::MAX_USHORT_VERTICES / column - 1, 0);
+	const auto bandSize = stripsPerBand > 0 ? std::min(stripsPerBand, _segmentsX) : _segmentsX;
+
+	// Every band indexes its vertices from its first column on, which becomes its base vertex
+	auto indices = std::vector<unsigned>{};
+	indices.reserve(static_cast<std::size_t>(bandSize) * (2 * column + 1));
+	for (auto first = 0; first < _segmentsX; first += bandSize) {
+		indices.clear();
+		const auto last = std::min(first + bandSize, _segmentsX);
+		// Vertices go column by column, each strip zips two neighbouring columns together
+		for (auto i = 0; i < last - first; ++i) {
+			if (i > 0) {
+				indices.push_back(restart);
+			}
+			for (auto j = 0; j < column; ++j) {
+				indices.push_back(j + i * column);
+				indices.push_back(j + (i + 1) * column);
+			}
 		}
+		geometry.addPart(RenderableManager::PrimitiveType::TRIANGLE_STRIP, indices, first * column);
+	}
+}
 
-		const auto indexBuffer = IndexBuffer::Builder()
-			.indexCount(static_cast<int>(indices.size()))
-			.indexType(IndexBuffer::Builder::IndexType::UINT)
-			.build(engine);
-		indexBuffer->setBuffer(indices.data());
+std::vector<float> Mesh::Builder::sampleHeights() const {
+	const auto xStep = _halfExtentX * 2 / static_cast<float>(_segmentsX);
+	const auto yStep = _halfExtentY * 2 / static_cast<float>(_segmentsY);
+	const auto columnSize = getPaddedColumnSize();
 
-		renderableBuilder
-            .geometry(i, RenderableManager::PrimitiveType::TRIANGLE_STRIP, *vertexBuffer, *indexBuffer,static_cast<int>(indices.size()), 0)
-            .shader(i, shader);
+	// Every column shares the same y values, from one step above the top edge to one below the bottom one
+	auto ys = std::vector<float>(columnSize);
+	for (auto j = 0; j < columnSize; ++j) {
+		ys[j] = _halfExtentY - static_cast<float>(j - 1) * yStep;
 	}
-	renderableBuilder.build(entity);
 
-	return std::unique_ptr<Drawable>(new Mesh(entity, shader));
+	auto heights = std::vector<float>(static_cast<std::size_t>(_segmentsX + 3) * columnSize);
+	ThreadPool::get()->parallelFor(0, _segmentsX + 3, [&](const int first, const int last) {
+		auto xs = std::vector<float>(columnSize);
+		for (auto i = first; i < last; ++i) {
+			const auto x = static_cast<float>(i - 1) * xStep - _halfExtentX;
+			const auto column = std::span(heights).subspan(static_cast<std::size_t>(i) * columnSize, columnSize);
+			if (_batchFunc) {
+				std::ranges::fill(xs, x);
+				_batchFunc(xs, ys, column);
+			} else {
+				for (auto j = 0; j < columnSize; ++j) {
+					column[j] = _func(x, ys[j]);
+				}
+			}
+		}
+	});
+	return heights;
+}
+
+int Mesh::Builder::getPaddedColumnSize() const {
+	return _segmentsY + 3;
 }
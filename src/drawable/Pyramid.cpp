@@ -11,8 +11,9 @@
 using namespace glm;
 using namespace srgb;
 
-std::unique_ptr<Drawable> Pyramid::Builder::build(Engine& engine) {
-    const auto positions = std::vector{
+Geometry Pyramid::Builder::generate() const {
+    auto geometry = Geometry{};
+    geometry.positions = std::vector{
         // Side +X
          0.0f,  0.0f,  1.0f,
          1.0f, -1.0f, -1.0f,
@@ -40,7 +41,7 @@ std::unique_ptr<Drawable> Pyramid::Builder::build(Engine& engine) {
     const auto xnNorm = normalize(cross(vec3{  0.0f, -1.0f, 0.0f }, vec3{  1.0f,  0.0f, 1.0f }));
     const auto ypNorm = normalize(cross(vec3{ -1.0f,  0.0f, 0.0f }, vec3{  0.0f, -1.0f, 1.0f }));
     const auto ynNorm = normalize(cross(vec3{  1.0f,  0.0f, 0.0f }, vec3{  0.0f,  1.0f, 1.0f }));
-    const auto normals = std::vector{
+    geometry.normals = std::vector{
         // Side +X
         xpNorm.x, xpNorm.y, xpNorm.z,
         xpNorm.x, xpNorm.y, xpNorm.z,
@@ -64,7 +65,7 @@ std::unique_ptr<Drawable> Pyramid::Builder::build(Engine& engine) {
         0.0f,  0.0f, -1.0f,
     };
 
-    const auto colors = std::vector{
+    geometry.colors = std::vector{
         // Side X+
         WHITE[0],    WHITE[1],    WHITE[2],    1.0f,
         GREEN[0],    GREEN[1],    GREEN[2],    1.0f,
@@ -88,7 +89,7 @@ std::unique_ptr<Drawable> Pyramid::Builder::build(Engine& engine) {
         BLUE[0],     BLUE[1],     BLUE[2],     1.0f,
     };
 
-    const auto texCoords = std::vector{
+    geometry.uvs = std::vector{
         0.5f, 0.0f,
         0.0f, 1.0f,
         1.0f, 1.0f,
@@ -112,40 +113,20 @@ std::unique_ptr<Drawable> Pyramid::Builder::build(Engine& engine) {
     };
 
     // Draw 4 triangles first, then draw the base square
-    const auto vertexCount = 4 * 3 + 4;
-    auto indices = std::vector<unsigned>{};
-    for (auto i = 0; i < vertexCount; ++i) {
-        indices.push_back(i);
+    auto sideIndices = std::vector<unsigned>{};
+    for (auto i = 0u; i < 4 * 3; ++i) {
+        sideIndices.push_back(i);
     }
+    geometry.addPart(RenderableManager::PrimitiveType::TRIANGLES, sideIndices);
+    geometry.addPart(RenderableManager::PrimitiveType::TRIANGLE_STRIP, { 12, 13, 14, 15 });
+    return geometry;
+}
 
-	constexpr auto floatSize = 4;
-	const auto vertexBuffer = VertexBuffer::Builder(4)
-		.vertexCount(vertexCount)
-		.attribute(0, VertexBuffer::VertexAttribute::POSITION, VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.attribute(1, VertexBuffer::VertexAttribute::NORMAL, VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-        .attribute(2, VertexBuffer::VertexAttribute::COLOR, VertexBuffer::AttributeType::FLOAT4, 0, floatSize * 4)
-        .attribute(3, VertexBuffer::VertexAttribute::UV0, VertexBuffer::AttributeType::FLOAT2, 0, floatSize * 2)
-		.build(engine);
-	vertexBuffer->setBufferAt(0, positions.data());
-    vertexBuffer->setBufferAt(1, normals.data());
-	vertexBuffer->setBufferAt(2, colors.data());
-    vertexBuffer->setBufferAt(3, texCoords.data());
-
-	const auto indexBuffer = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(indices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	indexBuffer->setBuffer(indices.data());
-
+std::unique_ptr<Drawable> Pyramid::Builder::build(Engine& engine) {
+    const auto geometry = generate();
 	const auto shader = defaultShader(engine);
-
 	const auto entity = EntityManager::get()->create();
-	RenderableManager::Builder(2)
-		.geometry(0, RenderableManager::PrimitiveType::TRIANGLES, *vertexBuffer, *indexBuffer, 4 * 3, 0)
-		.shader(0, shader)
-		.geometry(1, RenderableManager::PrimitiveType::TRIANGLE_STRIP, *vertexBuffer, *indexBuffer, 4, 4 * 3)
-		.shader(1, shader)
-		.build(entity);
+	upload(engine, geometry, shader).build(entity);
 
 	return std::unique_ptr<Drawable>(new Pyramid(entity, shader));
 }
\ No newline at end of file
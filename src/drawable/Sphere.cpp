@@ -1,14 +1,16 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <glm/geometric.hpp>
 #include <numbers>
 #include <ranges>
+#include <unordered_map>
 #include <vector>
 
-#include "VertexBuffer.h"
-#include "IndexBuffer.h"
 #include "RenderableManager.h"
 
 #include "drawable/Sphere.h"
@@ -24,20 +26,26 @@ Sphere::GeographicBuilder& Sphere::GeographicBuilder::latitudes(const int amount
 	return *this;
 }
 
-std::unique_ptr<Drawable> Sphere::GeographicBuilder::build(Engine& engine) {
-	auto positions = std::vector<float>{};
-	auto colors = std::vector<float>{};
-	auto normals = std::vector<float>{};
-    auto texCoords = std::vector<float>{};
+Geometry Sphere::GeographicBuilder::generate() const {
+	auto geometry = Geometry{};
+	const auto vertexCount = 2 * _longitudes + (_latitudes - 1) * (_longitudes + 1);
+	geometry.positions.reserve(3 * vertexCount);
+	geometry.colors.reserve(4 * vertexCount);
+	geometry.normals.reserve(3 * vertexCount);
+	geometry.uvs.reserve(2 * vertexCount);
+	const auto addVertex = [&geometry](const glm::vec3& position, const std::array<float, 3>& rgb, const float u, const float v) {
+		geometry.positions.insert(geometry.positions.end(), { position.x, position.y, position.z });
+		geometry.colors.insert(geometry.colors.end(), { rgb[0], rgb[1], rgb[2], 1.0f });
+		// Every point lies on the unit sphere, so it doubles as its normal
+		geometry.normals.insert(geometry.normals.end(), { position.x, position.y, position.z });
+		geometry.uvs.insert(geometry.uvs.end(), { u, v });
+	};
 
 	// Top vertices. We will need more than just one top vertex for correct texture mapping.
     for (auto i = 0; i < _longitudes; ++i) {
-        positions.push_back(0.0f); positions.push_back(0.0f); positions.push_back(1.0f);
-        colors.push_back(srgb::RED[0]); colors.push_back(srgb::RED[1]); colors.push_back(srgb::RED[2]); colors.push_back(1.0f);
-        normals.push_back(0.0f); normals.push_back(0.0f); normals.push_back(1.0f);
         // We divide by (longitudes - 1) to make sure the final u-texCoord reach 1.0f
         const auto u = static_cast<float>(i) / static_cast<float>(_longitudes - 1);
-        texCoords.push_back(u); texCoords.push_back(0.0f);
+        addVertex({ 0.0f, 0.0f, 1.0f }, { srgb::RED[0], srgb::RED[1], srgb::RED[2] }, u, 0.0f);
     }
 
     // Side vertices
@@ -54,44 +62,20 @@ std::unique_ptr<Drawable> Sphere::GeographicBuilder::build(Engine& engine) {
 
 			const auto dir = normalize(glm::vec3{ diX, diY, diZ });
 
-			positions.push_back(dir.x); positions.push_back(dir.y); positions.push_back(dir.z);
-
 			const auto rgb = srgb::heatColorAt(dir.z);
-			colors.insert(colors.end(), rgb.begin(), rgb.end());
-			colors.push_back(1.0f);
-
-			normals.push_back(dir.x); normals.push_back(dir.y); normals.push_back(dir.z);
-
             const auto u = static_cast<float>(j) / static_cast<float>(_longitudes);
             const auto v = static_cast<float>(i) / static_cast<float>(_latitudes);
-            texCoords.push_back(u); texCoords.push_back(v);
+			addVertex(dir, { rgb[0], rgb[1], rgb[2] }, u, v);
 		}
 	}
 
     // Bottom vertices. Again, we will need more than just one bottom vertex for correct texture mapping.
     for (auto i = 0; i < _longitudes; ++i) {
-        positions.push_back(0.0f); positions.push_back(0.0f); positions.push_back(-1.0f);
-        colors.push_back(srgb::BLUE[0]); colors.push_back(srgb::BLUE[1]); colors.push_back(srgb::BLUE[2]); colors.push_back(1.0f);
-        normals.push_back(0.0f); normals.push_back(0.0f); normals.push_back(-1.0f);
         // We divide by (longitudes - 1) to make sure the final u-texCoord reach 1.0f
         const auto u = static_cast<float>(i) / static_cast<float>(_longitudes - 1);
-        texCoords.push_back(u); texCoords.push_back(1.0f);
+        addVertex({ 0.0f, 0.0f, -1.0f }, { srgb::BLUE[0], srgb::BLUE[1], srgb::BLUE[2] }, u, 1.0f);
     }
 
-	constexpr auto floatSize = 4;
-    const auto vertexCount = static_cast<int>(positions.size()) / 3;
-	const auto vertexBuffer = VertexBuffer::Builder(4)
-		.vertexCount(vertexCount)
-		.attribute(0, VertexBuffer::VertexAttribute::POSITION,VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.attribute(1, VertexBuffer::VertexAttribute::NORMAL,VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.attribute(2, VertexBuffer::VertexAttribute::COLOR,VertexBuffer::AttributeType::FLOAT4, 0, floatSize * 4)
-        .attribute(3, VertexBuffer::VertexAttribute::UV0, VertexBuffer::AttributeType::FLOAT2, 0, floatSize * 2)
-		.build(engine);
-	vertexBuffer->setBufferAt(0, positions.data());
-	vertexBuffer->setBufferAt(1, normals.data());
-	vertexBuffer->setBufferAt(2, colors.data());
-    vertexBuffer->setBufferAt(3, texCoords.data());
-
 	auto stripIndices = std::vector<unsigned>{};
     // Each pass handle two consecutive strips, and we start from the second strip, hence latitudes - 2
 	for (auto i = 0; i < _latitudes - 2; ++i) {
@@ -108,11 +92,7 @@ std::unique_ptr<Drawable> Sphere::GeographicBuilder::build(Engine& engine) {
 			stripIndices.push_back((i + 1u) * (_longitudes + 1u) + _longitudes + _longitudes);
 		}
 	}
-	const auto stripBuffer = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(stripIndices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	stripBuffer->setBuffer(stripIndices.data());
+	geometry.addPart(RenderableManager::PrimitiveType::TRIANGLE_STRIP, stripIndices);
 
 	auto topIndices = std::vector<unsigned>{};
     for (auto i = 0; i < _longitudes; ++i) {
@@ -122,11 +102,7 @@ std::unique_ptr<Drawable> Sphere::GeographicBuilder::build(Engine& engine) {
         topIndices.push_back(i + _longitudes);
         topIndices.push_back(i + _longitudes + 1);
     }
-	const auto topBuffer = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(topIndices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	topBuffer->setBuffer(topIndices.data());
+	geometry.addPart(RenderableManager::PrimitiveType::TRIANGLES, topIndices);
 
 	auto botIndices = std::vector<unsigned>{};
 	for (auto i = 0; i < _longitudes; ++i) {
@@ -136,22 +112,16 @@ std::unique_ptr<Drawable> Sphere::GeographicBuilder::build(Engine& engine) {
         botIndices.push_back(vertexCount - 1 - i - _longitudes);
         botIndices.push_back(vertexCount - 1 - i - _longitudes - 1);
 	}
-	const auto botBuffer = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(botIndices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	botBuffer->setBuffer(botIndices.data());
+	geometry.addPart(RenderableManager::PrimitiveType::TRIANGLES, botIndices);
+
+	return geometry;
+}
 
+std::unique_ptr<Drawable> Sphere::GeographicBuilder::build(Engine& engine) {
+	const auto geometry = generate();
 	const auto shader = defaultShader(engine);
 	const auto entity = EntityManager::get()->create();
-	RenderableManager::Builder(3)
-		.geometry(0, RenderableManager::PrimitiveType::TRIANGLE_STRIP, *vertexBuffer, *stripBuffer,static_cast<int>(stripIndices.size()), 0)
-		.shader(0, shader)
-		.geometry(1, RenderableManager::PrimitiveType::TRIANGLES, *vertexBuffer, *topBuffer,static_cast<int>(topIndices.size()), 0)
-		.shader(1, shader)
-		.geometry(2, RenderableManager::PrimitiveType::TRIANGLES, *vertexBuffer, *botBuffer,static_cast<int>(botIndices.size()), 0)
-		.shader(2, shader)
-		.build(entity);
+	upload(engine, geometry, shader).build(entity);
 
 	return std::unique_ptr<Drawable>(new Sphere(entity, shader));
 }
@@ -172,105 +142,125 @@ Sphere::SubdivisionBuilder& Sphere::SubdivisionBuilder::initialPolygon(const Pol
 }
 
 Sphere::SubdivisionBuilder& Sphere::SubdivisionBuilder::uniformColor(const float r, const float g, const float b) {
-	if (!_uniformColor) {
-		_uniformColor = new float[3] { r, g, b };
-	} else {
-		_uniformColor[0] = r;
-		_uniformColor[1] = g;
-		_uniformColor[2] = b;
-	}
+	_uniformColor = std::array{ r, g, b };
 	return *this;
 }
 
-std::unique_ptr<Drawable> Sphere::SubdivisionBuilder::build(Engine& engine) {
+Geometry Sphere::SubdivisionBuilder::generate() const {
 	const auto faces = getFaces();
 	const auto faceCount = static_cast<int>(faces.size() / 3);
 
-	auto positions = std::vector<float>{};
-	auto colors = std::vector<float>{};
-	auto normals = std::vector<float>{};
-
-	for (auto i = 0; i < faceCount; ++i) {
-		const auto p0 = faces[i * 3 + 0];
-		const auto p1 = faces[i * 3 + 1];
-		const auto p2 = faces[i * 3 + 2];
-
-		const auto data = subdivide(p0, p1, p2, _depth);
-		positions.insert(positions.end(), data.begin(), data.end());
-		normals.insert(normals.end(), data.begin(), data.end());
-
-		const auto count = static_cast<int>(data.size() / 3);
-		if (!_uniformColor) {
-			const auto color = srgb::hueAt(i);
-			for (auto j = 0; j < count; ++j) {
-				colors.insert(colors.end(), color.begin(), color.end());
-				colors.push_back(1.0f);
+	// Every subdivision turns a triangle into four, and a triangle subdivided n times has (2^n + 1)(2^n + 2) / 2
+	// distinct vertices
+	const auto sideSegments = std::size_t{ 1 } << _depth;
+	const auto trianglesPerFace = sideSegments * sideSegments;
+	const auto verticesPerFace = (sideSegments + 1) * (sideSegments + 2) / 2;
+
+	auto positions = std::vector<glm::vec3>{};
+	auto triangles = std::vector<unsigned>{};
+	auto hues = std::vector<std::array<float, 3>>{};
+	if (_uniformColor) {
+		// A single color lets neighbouring faces share the vertices along their common edges as well.
+		// Closed meshes of triangles have V = F / 2 + 2.
+		positions.reserve(faceCount * trianglesPerFace / 2 + 2);
+		triangles.reserve(3 * faceCount * trianglesPerFace);
+		for (const auto& corner : faces) {
+			const auto found = std::ranges::find(positions, corner);
+			if (found == positions.end()) {
+				triangles.push_back(static_cast<unsigned>(positions.size()));
+				positions.push_back(corner);
+			} else {
+				triangles.push_back(static_cast<unsigned>(found - positions.begin()));
 			}
-		} else {
-			for (auto j = 0; j < count; ++j) {
-				colors.insert(colors.end(), _uniformColor, _uniformColor + 3);
-				colors.push_back(1.0f);
+		}
+		subdivide(positions, triangles);
+		hues.assign(positions.size(), *_uniformColor);
+	} else {
+		// Faces have their own colors, so each is subdivided on its own vertices
+		positions.reserve(faceCount * verticesPerFace);
+		triangles.reserve(3 * faceCount * trianglesPerFace);
+		hues.reserve(faceCount * verticesPerFace);
+		auto facePositions = std::vector<glm::vec3>{};
+		auto faceTriangles = std::vector<unsigned>{};
+		facePositions.reserve(verticesPerFace);
+		faceTriangles.reserve(3 * trianglesPerFace);
+		for (auto i = 0; i < faceCount; ++i) {
+			facePositions.assign(faces.begin() + i * 3, faces.begin() + i * 3 + 3);
+			faceTriangles.assign({ 0u, 1u, 2u });
+			subdivide(facePositions, faceTriangles);
+
+			const auto first = static_cast<unsigned>(positions.size());
+			positions.insert(positions.end(), facePositions.begin(), facePositions.end());
+			for (const auto index : faceTriangles) {
+				triangles.push_back(first + index);
 			}
+			hues.insert(hues.end(), facePositions.size(), srgb::hueAt(i));
 		}
 	}
-	delete _uniformColor;
-
-    // Fill the index buffer with incremental values
-	const auto vertexCount = static_cast<int>(positions.size() / 3);
-	auto indices = std::vector<unsigned>(vertexCount);
-    auto iotaView = std::ranges::iota_view(0);
-    std::ranges::copy(iotaView.begin(), iotaView.begin() + vertexCount, indices.begin());
-
-	constexpr auto floatSize = 4;
-	const auto vertexBuffer = VertexBuffer::Builder(3)
-		.vertexCount(vertexCount)
-		.attribute(0, VertexBuffer::VertexAttribute::POSITION,VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.attribute(1, VertexBuffer::VertexAttribute::COLOR,VertexBuffer::AttributeType::FLOAT4, 0, floatSize * 4)
-		.attribute(2, VertexBuffer::VertexAttribute::NORMAL,VertexBuffer::AttributeType::FLOAT3, 0, floatSize * 3)
-		.build(engine);
-	vertexBuffer->setBufferAt(0, positions.data());
-	vertexBuffer->setBufferAt(1, colors.data());
-	vertexBuffer->setBufferAt(2, normals.data());
-
-	const auto indexBuffer = IndexBuffer::Builder()
-		.indexCount(static_cast<int>(indices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
-		.build(engine);
-	indexBuffer->setBuffer(indices.data());
 
+	auto geometry = Geometry{};
+	geometry.positions.reserve(3 * positions.size());
+	geometry.normals.reserve(3 * positions.size());
+	geometry.colors.reserve(4 * positions.size());
+	for (std::size_t v = 0; v < positions.size(); ++v) {
+		// Every point lies on the sphere, so it doubles as its normal
+		const auto& point = positions[v];
+		geometry.positions.insert(geometry.positions.end(), { point.x, point.y, point.z });
+		geometry.normals.insert(geometry.normals.end(), { point.x, point.y, point.z });
+		geometry.colors.insert(geometry.colors.end(), { hues[v][0], hues[v][1], hues[v][2], 1.0f });
+	}
+	geometry.addPart(RenderableManager::PrimitiveType::TRIANGLES, triangles);
+
+	return geometry;
+}
+
+std::unique_ptr<Drawable> Sphere::SubdivisionBuilder::build(Engine& engine) {
+	const auto geometry = generate();
 	const auto shader = defaultShader(engine);
 	const auto entity = EntityManager::get()->create();
-	RenderableManager::Builder(1)
-		.geometry(0, RenderableManager::PrimitiveType::TRIANGLES, *vertexBuffer, *indexBuffer,static_cast<int>(indices.size()), 0)
-		.shader(0, shader)
-		.build(entity);
+	upload(engine, geometry, shader).build(entity);
 
 	return std::unique_ptr<Drawable>(new Sphere(entity, shader));
 }
 
-std::vector<float> Sphere::SubdivisionBuilder::subdivide(
-	const glm::vec3& p0, 
-	const glm::vec3& p1, 
-	const glm::vec3& p2,
-	const int depth
-) const {
-	if (depth == 0) {
-		return std::vector{ p0.x, p0.y, p0.z, p1.x, p1.y, p1.z, p2.x, p2.y, p2.z };
+void Sphere::SubdivisionBuilder::subdivide(std::vector<glm::vec3>& positions, std::vector<unsigned>& triangles) const {
+	// Midpoints by the edge they split, keyed by the edge's two vertices with the smaller one first
+	auto midpoints = std::unordered_map<std::uint64_t, unsigned>{};
+	const auto midpoint = [this, &positions, &midpoints](const unsigned a, const unsigned b) {
+		const auto key = static_cast<std::uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+		const auto [it, inserted] = midpoints.try_emplace(key, static_cast<unsigned>(positions.size()));
+		if (inserted) {
+			positions.push_back(_radius * normalize((positions[a] + positions[b]) / 2.0f));
+		}
+		return it->second;
+	};
+
+	auto next = std::vector<unsigned>{};
+	for (auto level = 0; level < _depth; ++level) {
+		const auto triangleCount = triangles.size() / 3;
+		// Every triangle adds three midpoints at most, the callers reserve the positions they expect
+		midpoints.clear();
+		midpoints.reserve(3 * triangleCount);
+		next.clear();
+		next.reserve(4 * triangles.size());
+
+		for (std::size_t t = 0; t < triangleCount; ++t) {
+			const auto p0 = triangles[3 * t];
+			const auto p1 = triangles[3 * t + 1];
+			const auto p2 = triangles[3 * t + 2];
+			const auto m0 = midpoint(p1, p2);
+			const auto m1 = midpoint(p0, p2);
+			const auto m2 = midpoint(p0, p1);
+
+			next.insert(next.end(), {
+				p0, m2, m1,
+				m2, p1, m0,
+				m0, m1, m2,
+				m1, m0, p2,
+			});
+		}
+		triangles.swap(next);
 	}
-	const auto m0 = _radius * normalize((p1 + p2) / 2.0f);
-	const auto m1 = _radius * normalize((p0 + p2) / 2.0f);
-	const auto m2 = _radius * normalize((p0 + p1) / 2.0f);
-
-	auto vec0 = subdivide(p0, m2, m1, depth - 1);
-	const auto vec1 = subdivide(m2, p1, m0, depth - 1);
-	const auto vec2 = subdivide(m0, m1, m2, depth - 1);
-	const auto vec3 = subdivide(m1, m0, p2, depth - 1);
-
-	vec0.insert(vec0.end(), vec1.begin(), vec1.end());
-	vec0.insert(vec0.end(), vec2.begin(), vec2.end());
-	vec0.insert(vec0.end(), vec3.begin(), vec3.end());
-
-	return vec0;
 }
 
 std::vector<glm::vec3> Sphere::SubdivisionBuilder::getFaces() const {
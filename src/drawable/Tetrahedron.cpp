@@ -103,7 +103,7 @@ std::unique_ptr<Drawable> Tetrahedron::Builder::build(Engine& engine) {
 
 	const auto indexBuffer = IndexBuffer::Builder()
 		.indexCount(static_cast<int>(indices.size()))
-		.indexType(IndexBuffer::Builder::IndexType::UINT)
+		.fitIndexType(vertexBuffer->getVertexCount())
 		.build(engine);
 	indexBuffer->setBuffer(indices.data());
 
@@ -112,6 +112,7 @@ std::unique_ptr<Drawable> Tetrahedron::Builder::build(Engine& engine) {
 	RenderableManager::Builder(1)
 		.geometry(0, RenderableManager::PrimitiveType::TRIANGLES, *vertexBuffer, *indexBuffer,static_cast<int>(indices.size()), 0)
 		.shader(0, shader)
+		.boundingBox(positions)
 		.build(entity);
 
 	return std::unique_ptr<Drawable>(new Tetrahedron(entity, shader));
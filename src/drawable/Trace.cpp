@@ -2,8 +2,10 @@
 // All rights reserved.
 
 #include <glm/geometric.hpp>
+#include <glm/vec4.hpp>
 #include <vector>
 
+#include "Engine.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "RenderableManager.h"
@@ -35,36 +37,33 @@ Trace::Builder &Trace::Builder::size(const float size) {
     return *this;
 }
 
-std::unique_ptr<Drawable> Trace::Builder::build(Engine &engine) {
-    const auto sideDir = glm::normalize(glm::cross(_direction, _normal));
-    const auto pM = _position + (_size / 2.0f) * sideDir;
-    const auto cornDir = glm::normalize(glm::cross(pM - _position, _normal));
-
-    const auto p0 = pM + (_size / 2.0f) *  cornDir;
-    const auto p1 = pM + (_size / 2.0f) * -cornDir;
-    const auto p2 = p0 + _size * -sideDir;
-    const auto p3 = p1 + _size * -sideDir;
+Trace::Builder &Trace::Builder::capacity(const int capacity) {
+    _capacity = capacity;
+    return *this;
+}
 
+std::unique_ptr<Drawable> Trace::Builder::build(Engine &engine) {
+    // A unit quad in the XY plane, each instance places it with its own transform
     const auto positions = std::vector{
-        p0.x, p0.y, p0.z,
-        p1.x, p1.y, p1.z,
-        p2.x, p2.y, p2.z,
-        p3.x, p3.y, p3.z,
+         0.5f,  0.5f, 0.0f,
+         0.5f, -0.5f, 0.0f,
+        -0.5f,  0.5f, 0.0f,
+        -0.5f, -0.5f, 0.0f,
     };
 
+    // The trace color comes from the instance, which is multiplied with the vertex color
     const auto colors = std::vector{
-        _color.r, _color.g, _color.b, 1.0f,
-        _color.r, _color.g, _color.b, 1.0f,
-        _color.r, _color.g, _color.b, 1.0f,
-        _color.r, _color.g, _color.b, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
     };
 
-    const auto normal = glm::normalize(_normal);
     const auto normals = std::vector{
-        normal.x, normal.y, normal.z,
-        normal.x, normal.y, normal.z,
-        normal.x, normal.y, normal.z,
-        normal.x, normal.y, normal.z,
+        0.0f, 0.0f, 1.0f,
+        0.0f, 0.0f, 1.0f,
+        0.0f, 0.0f, 1.0f,
+        0.0f, 0.0f, 1.0f,
     };
 
     const auto indices = std::vector{ 0u, 1u, 2u, 3u };
@@ -82,18 +81,36 @@ std::unique_ptr<Drawable> Trace::Builder::build(Engine &engine) {
 
     const auto indexBuffer = IndexBuffer::Builder()
         .indexCount(static_cast<int>(indices.size()))
-        .indexType(IndexBuffer::Builder::IndexType::UINT)
+        .fitIndexType(vertexBuffer->getVertexCount())
         .build(engine);
     indexBuffer->setBuffer(indices.data());
 
-    const auto shader = defaultShader(engine);
+    const auto shader = defaultShader(engine, { Shader::Feature::INSTANCED });
     const auto entity = EntityManager::get()->create();
     RenderableManager::Builder(1)
         .geometry(0, RenderableManager::PrimitiveType::TRIANGLE_STRIP, *vertexBuffer, *indexBuffer,static_cast<int>(indices.size()), 0)
         .shader(0, shader)
+        .instanced(_capacity)
         .build(entity);
 
+    engine.getRenderableManager()->addInstance(
+        entity, getInstanceTransform(_position, _direction, _normal, _size), glm::vec4{ _color, 1.0f });
+
     return std::unique_ptr<Drawable>(new Trace(entity, shader));
 }
 
-
+glm::mat4 Trace::getInstanceTransform(
+    const glm::vec3 &position, const glm::vec3 &direction, const glm::vec3 &normal, const float size
+) {
+    // Same corners as laying the quad out around the position: one side across the direction, the other along it
+    const auto sideDir = glm::normalize(glm::cross(direction, normal));
+    const auto cornDir = glm::normalize(glm::cross(sideDir, normal));
+    const auto normalDir = glm::normalize(normal);
+
+    return {
+        glm::vec4{ sideDir * size, 0.0f },
+        glm::vec4{ cornDir * size, 0.0f },
+        glm::vec4{ normalDir * size, 0.0f },
+        glm::vec4{ position, 1.0f },
+    };
+}
@@ -1,7 +1,7 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
-#include "EntityManager.h"
+#include "RenderableManager.h"
 #include "drawable/Trace.h"
 
 #include "utils/ContourTracer.h"
@@ -47,33 +47,15 @@ std::unique_ptr<ContourTracer> ContourTracer::Builder::build() {
 }
 
 void ContourTracer::resetTo(const float x, const float y, Scene &scene, Engine &engine) {
-    // Remove and clean up all current traces
-    const auto entityManager = EntityManager::get();
-    for (const auto& trace : _currentTraces) {
-        scene.removeEntity(trace->getEntity());
-        engine.destroyEntity(trace->getEntity());
-        engine.destroyShader(trace->getShader());
-        entityManager->discard(trace->getEntity());
-    }
-    _currentTraces.clear();
+    // Drop all current traces, their batches stay alive to take the next ones
+    const auto renderableManager = engine.getRenderableManager();
+    if (_marks) renderableManager->clearInstances(_marks->getEntity());
+    if (_traces) renderableManager->clearInstances(_traces->getEntity());
 
     // Create a mark at this position
-    const auto norm = glm::vec3{ 0.0f, 0.0f, 1.0f };
-    auto mark = Trace::Builder()
-            .position(x, y, 0.0f)
-            .normal(norm)
-            .direction(glm::vec3{ -_gradientX(x, y), -_gradientY(x, y), 0.0f })
-            .color(_markColor.r, _markColor.g, _markColor.b)
-            .size(_traceSize)
-            .shaderModel(Shader::Model::UNLIT)
-            .build(engine);
-
-    // Pad the mark and add to the scene
-    const auto tm = engine.getTransformManager();
-    tm->setTransform(mark->getEntity(), glm::translate(glm::mat4(1.0f), norm * _heightPadding));
-    scene.addEntity(mark->getEntity());
+    const auto direction = glm::vec3{ -_gradientX(x, y), -_gradientY(x, y), 0.0f };
+    place(_marks, glm::vec3{ x, y, 0.0f }, direction, _markColor, scene, engine);
 
-    _currentTraces.push_back(std::move(mark));
     _currentX = x;
     _currentY = y;
 }
@@ -94,23 +76,34 @@ void ContourTracer::traceTo(const float x, const float y, Scene &scene, Engine &
         // Draw a trace at the current position
         const auto gradX = _gradientX(_currentX, _currentY);
         const auto gradY = _gradientY(_currentX, _currentY);
-        const auto norm = glm::vec3{ 0.0f, 0.0f, 1.0f };
-
-        auto trace = Trace::Builder()
-                .position(_currentX, _currentY, 0.0f)
-                .normal(norm)
-                .direction(glm::vec3{ -gradX, -gradY, 0.0f })
-                .color(_traceColor.r, _traceColor.g, _traceColor.b)
-                .size(_traceSize)
-                .shaderModel(Shader::Model::UNLIT)
-                .build(engine);
-
-        // Pad the mark and add to the scene
-        const auto tm = engine.getTransformManager();
-        tm->setTransform(trace->getEntity(), glm::translate(glm::mat4(1.0f), norm * _heightPadding));
-        scene.addEntity(trace->getEntity());
-        _currentTraces.push_back(std::move(trace));
+        const auto direction = glm::vec3{ -gradX, -gradY, 0.0f };
+        place(_traces, glm::vec3{ _currentX, _currentY, 0.0f }, direction, _traceColor, scene, engine);
 
         distance -= 2 * _traceSize;
     }
 }
+
+void ContourTracer::place(
+    std::unique_ptr<Drawable> &batch, const glm::vec3 &position, const glm::vec3 &direction,
+    const glm::vec3 &color, Scene &scene, Engine &engine
+) const {
+    // Contours are flat, pad the trace straight up
+    const auto norm = glm::vec3{ 0.0f, 0.0f, 1.0f };
+    const auto padded = position + norm * _heightPadding;
+
+    if (batch) {
+        const auto transform = Trace::getInstanceTransform(padded, direction, norm, _traceSize);
+        engine.getRenderableManager()->addInstance(batch->getEntity(), transform, glm::vec4{ color, 1.0f });
+        return;
+    }
+
+    batch = Trace::Builder()
+            .position(padded.x, padded.y, padded.z)
+            .normal(norm)
+            .direction(direction)
+            .color(color.r, color.g, color.b)
+            .size(_traceSize)
+            .shaderModel(Shader::Model::UNLIT)
+            .build(engine);
+    scene.addEntity(batch->getEntity());
+}
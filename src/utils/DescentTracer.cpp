@@ -3,7 +3,7 @@
 
 #include <stdexcept>
 
-#include "EntityManager.h"
+#include "RenderableManager.h"
 #include "drawable/Trace.h"
 #include "utils/DescentTracer.h"
 
@@ -69,38 +69,16 @@ std::unique_ptr<DescentTracer> DescentTracer::Builder::build() {
 }
 
 void DescentTracer::resetTo(const float x, const float y, Scene &scene, Engine &engine) {
-    // Remove and clean up all current traces
-    const auto entityManager = EntityManager::get();
-    for (const auto& trace : _currentTraces) {
-        scene.removeEntity(trace->getEntity());
-        engine.destroyEntity(trace->getEntity());
-        engine.destroyShader(trace->getShader());
-        entityManager->discard(trace->getEntity());
-    }
-    _currentTraces.clear();
+    // Drop all current traces, their batches stay alive to take the next ones
+    const auto renderableManager = engine.getRenderableManager();
+    if (_marks) renderableManager->clearInstances(_marks->getEntity());
+    if (_traces) renderableManager->clearInstances(_traces->getEntity());
 
     // Create a mark at this position
     const auto norm = getNormalAt(x, y);
-    auto markBuilder = Trace::Builder()
-            .position(x, y, _objective(x, y))
-            .normal(norm)
-            .direction(glm::vec3{ -_gradientX(x, y), -_gradientY(x, y), 0.0f })
-            .size(_traceSize);
+    const auto direction = glm::vec3{ -_gradientX(x, y), -_gradientY(x, y), 0.0f };
+    place(_marks, glm::vec3{ x, y, _objective(x, y) }, direction, norm, _markColor, _markMaterial, scene, engine);
 
-    if (_usePhong) {
-        markBuilder.shaderModel(Shader::Model::PHONG).phongMaterial(_markMaterial);
-    } else {
-        markBuilder.color(_markColor.r, _markColor.g, _markColor.b).shaderModel(Shader::Model::UNLIT);
-    }
-
-    auto mark = markBuilder.build(engine);
-
-    // Pad the mark and add to the scene
-    const auto tm = engine.getTransformManager();
-    tm->setTransform(mark->getEntity(), glm::translate(glm::mat4(1.0f), norm * _heightPadding));
-    scene.addEntity(mark->getEntity());
-
-    _currentTraces.push_back(std::move(mark));
     _currentX = x;
     _currentY = y;
 }
@@ -122,29 +100,42 @@ void DescentTracer::traceTo(const float x, const float y, Scene &scene, Engine &
         const auto gradX = _gradientX(_currentX, _currentY);
         const auto gradY = _gradientY(_currentX, _currentY);
         const auto norm = -glm::normalize(glm::vec3{ gradX, gradY, -1.0f });
+        const auto position = glm::vec3{ _currentX, _currentY, _objective(_currentX, _currentY) };
+        place(_traces, position, glm::vec3{ -gradX, -gradY, 0.0f }, norm, _traceColor, _traceMaterial, scene, engine);
 
-        auto traceBuilder = Trace::Builder()
-                .position(_currentX, _currentY, _objective(_currentX, _currentY))
-                .normal(norm)
-                .direction(glm::vec3{ -gradX, -gradY, 0.0f })
-                .size(_traceSize);
-
-        if (_usePhong) {
-            traceBuilder.shaderModel(Shader::Model::PHONG).phongMaterial(_traceMaterial);
-        } else {
-            traceBuilder.color(_traceColor.r, _traceColor.g, _traceColor.b).shaderModel(Shader::Model::UNLIT);
-        }
+        distance -= 2 * _traceSize;
+    }
+}
 
-        auto trace = traceBuilder.build(engine);
+void DescentTracer::place(
+    std::unique_ptr<Drawable> &batch, const glm::vec3 &position, const glm::vec3 &direction,
+    const glm::vec3 &normal, const glm::vec3 &color, const phong::Material &material,
+    Scene &scene, Engine &engine
+) const {
+    // Pad the trace above the surface
+    const auto padded = position + normal * _heightPadding;
+
+    if (batch) {
+        const auto transform = Trace::getInstanceTransform(padded, direction, normal, _traceSize);
+        const auto instanceColor = _usePhong ? glm::vec4{ 1.0f } : glm::vec4{ color, 1.0f };
+        engine.getRenderableManager()->addInstance(batch->getEntity(), transform, instanceColor);
+        return;
+    }
 
-        // Pad the mark and add to the scene
-        const auto tm = engine.getTransformManager();
-        tm->setTransform(trace->getEntity(), glm::translate(glm::mat4(1.0f), norm * _heightPadding));
-        scene.addEntity(trace->getEntity());
-        _currentTraces.push_back(std::move(trace));
+    auto builder = Trace::Builder()
+            .position(padded.x, padded.y, padded.z)
+            .normal(normal)
+            .direction(direction)
+            .size(_traceSize);
 
-        distance -= 2 * _traceSize;
+    if (_usePhong) {
+        builder.shaderModel(Shader::Model::PHONG).phongMaterial(material);
+    } else {
+        builder.color(color.r, color.g, color.b).shaderModel(Shader::Model::UNLIT);
     }
+
+    batch = builder.build(engine);
+    scene.addEntity(batch->getEntity());
 }
 
 glm::vec3 DescentTracer::getNormalAt(const float x, const float y) const {
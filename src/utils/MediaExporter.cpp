@@ -1,6 +1,7 @@
 // Copyright (c) 2023. Minh Nguyen
 // All rights reserved.
 
+#include <cstring>
 #include <iostream>
 #include <stb_image_write.h>
 
@@ -19,16 +20,148 @@ std::unique_ptr<MediaExporter> MediaExporter::Builder::build() const {
     return std::unique_ptr<MediaExporter>{ new MediaExporter(std::move(path)) };
 }
 
+MediaExporter::MediaExporter(std::filesystem::path&& dirPath) : _dirPath{ dirPath }, _encoder{ [this] { encode(); } } {
+}
+
+MediaExporter::~MediaExporter() {
+    flush();
+    for (auto& readback : _readbacks) {
+        if (readback.buffer != 0) {
+            glDeleteBuffers(1, &readback.buffer);
+        }
+    }
+
+    // The encoder finishes the queued images before it returns
+    {
+        std::scoped_lock lock{ _mutex };
+        _stopping = true;
+    }
+    _available.notify_one();
+}
+
 void MediaExporter::exportImage(
     const std::string_view name,
     const void* const data,
     const int width,
     const int height
-) const {
+) {
+    const auto bytes = static_cast<const unsigned char*>(data);
+    enqueue({ std::string{ name }, { bytes, bytes + static_cast<std::size_t>(width) * height * 4 }, width, height });
+}
+
+void MediaExporter::capture(const std::string_view name, const int x, const int y, const int width, const int height) {
+    auto& readback = _readbacks[_nextReadback];
+    _nextReadback = (_nextReadback + 1) % READBACK_COUNT;
+
+    // Every slot is still in flight, the oldest has to be let go
+    if (readback.fence != nullptr) {
+        complete(readback, true);
+    }
+
+    const auto size = static_cast<GLsizeiptr>(width) * height * 4;
+    if (readback.buffer == 0) {
+        glGenBuffers(1, &readback.buffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    if (readback.capacity < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        readback.capacity = size;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    // With a pack buffer bound the read is queued like any other command and returns right away
+    glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.name = std::string{ name };
+    readback.width = width;
+    readback.height = height;
+}
+
+void MediaExporter::poll() {
+    // Slots complete in issue order, so stop at the first one still in flight
+    for (auto i = 0; i < READBACK_COUNT; ++i) {
+        auto& readback = _readbacks[(_nextReadback + i) % READBACK_COUNT];
+        if (readback.fence == nullptr) {
+            continue;
+        }
+        const auto status = glClientWaitSync(readback.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        complete(readback, false);
+    }
+}
+
+void MediaExporter::flush() {
+    for (auto i = 0; i < READBACK_COUNT; ++i) {
+        auto& readback = _readbacks[(_nextReadback + i) % READBACK_COUNT];
+        if (readback.fence != nullptr) {
+            complete(readback, true);
+        }
+    }
+}
+
+void MediaExporter::complete(Readback& readback, const bool wait) {
+    if (wait) {
+        static constexpr GLuint64 TIMEOUT_NANOS = 1'000'000'000;
+        while (glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, TIMEOUT_NANOS) == GL_TIMEOUT_EXPIRED) {}
+    }
+    glDeleteSync(readback.fence);
+    readback.fence = nullptr;
+
+    const auto rowSize = static_cast<std::size_t>(readback.width) * 4;
+    auto pixels = std::vector<unsigned char>(rowSize * readback.height);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    const auto mapped = static_cast<const unsigned char*>(glMapBufferRange(
+        GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(pixels.size()), GL_MAP_READ_BIT
+    ));
+    if (mapped != nullptr) {
+        // OpenGL stores the bottom row first, images the top one
+        for (auto row = 0; row < readback.height; ++row) {
+            std::memcpy(pixels.data() + (readback.height - 1 - row) * rowSize, mapped + row * rowSize, rowSize);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        std::cerr << "MediaExporter: Failed to map the capture " << readback.name << '\n';
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (mapped != nullptr) {
+        enqueue({ std::move(readback.name), std::move(pixels), readback.width, readback.height });
+    }
+}
+
+void MediaExporter::enqueue(Job&& job) {
+    {
+        std::scoped_lock lock{ _mutex };
+        _jobs.push_back(std::move(job));
+    }
+    _available.notify_one();
+}
+
+void MediaExporter::encode() {
+    while (true) {
+        auto job = Job{};
+        {
+            std::unique_lock lock{ _mutex };
+            _available.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+            if (_jobs.empty()) {
+                return;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        write(job);
+    }
+}
+
+void MediaExporter::write(const Job& job) const {
     std::error_code err;
     if (std::filesystem::create_directories(_dirPath, err) || std::filesystem::exists(_dirPath)) {
-        const auto path = _dirPath.string() + std::string{ name } + ".png";
-        stbi_write_png(path.c_str(), width, height, 4, data, width * 4);
+        const auto path = _dirPath.string() + job.name + ".png";
+        stbi_write_png(path.c_str(), job.width, job.height, 4, job.pixels.data(), job.width * 4);
     } else {
         std::cerr << err.message() << '\n';
     }
@@ -0,0 +1,243 @@
+// Copyright (c) 2023. Minh Nguyen
+// All rights reserved.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#include "utils/Profiler.h"
+
+namespace {
+    const auto START_POINT = std::chrono::steady_clock::now();
+
+    // Trace-event timestamps are in microseconds
+    double toMicros(const std::int64_t nanos) {
+        return static_cast<double>(nanos) / 1000.0;
+    }
+}
+
+Profiler* Profiler::get() {
+    if (!_instance) {
+        _instance = new Profiler{};
+    }
+    return _instance;
+}
+
+Profiler::Profiler() : _ring{ std::make_unique<std::array<Slot, RING_CAPACITY>>() } {
+}
+
+void Profiler::setEnabled(const bool enabled) {
+    _enabled = enabled;
+}
+
+bool Profiler::isEnabled() const {
+    return _enabled;
+}
+
+std::int64_t Profiler::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - START_POINT).count();
+}
+
+void Profiler::beginFrame() {
+    if (!_enabled) {
+        return;
+    }
+
+    // The slot was last used FRAME_LATENCY frames ago, its queries are done unless the GPU is that far behind
+    auto& pending = _pending[_frameIndex % FRAME_LATENCY];
+    if (pending.waiting) {
+        resolve(pending);
+    }
+
+    _current = Frame{};
+    _current.index = _frameIndex;
+    _current.startNanos = now();
+    _viewCount = 0;
+    _inFrame = true;
+}
+
+void Profiler::endFrame() {
+    if (!_inFrame) {
+        return;
+    }
+    _inFrame = false;
+
+    _current.durationNanos = now() - _current.startNanos;
+    auto& pending = _pending[_frameIndex % FRAME_LATENCY];
+    pending.frame = _current;
+    pending.waiting = true;
+    ++_frameIndex;
+}
+
+int Profiler::nextView() {
+    return _viewCount++;
+}
+
+void Profiler::count(const Counters& counters) {
+    if (!_inFrame) {
+        return;
+    }
+    _current.counters.drawCalls += counters.drawCalls;
+    _current.counters.stateChanges += counters.stateChanges;
+    _current.counters.triangles += counters.triangles;
+}
+
+int Profiler::pushEvent(const char* const name, const int view, const bool gpu) {
+    if (!_inFrame || _current.eventCount == MAX_EVENTS) {
+        return -1;
+    }
+    const auto event = _current.eventCount++;
+    _current.events[event] = Event{ name, view, now(), 0, gpu };
+    return event;
+}
+
+void Profiler::resolve(PendingFrame& pending) {
+    for (const auto& [event, query] : pending.timings) {
+        auto nanos = GLint64{ 0 };
+        glGetQueryObjecti64v(query, GL_QUERY_RESULT, &nanos);
+        pending.frame.events[event].durationNanos = nanos;
+    }
+    pending.timings.clear();
+    pending.waiting = false;
+    publish(pending.frame);
+}
+
+void Profiler::publish(const Frame& frame) {
+    const auto published = _published.load(std::memory_order_relaxed);
+    auto& slot = (*_ring)[published % RING_CAPACITY];
+
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.frame = frame;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    _published.store(published + 1, std::memory_order_release);
+}
+
+std::vector<Profiler::Frame> Profiler::snapshot() const {
+    const auto published = _published.load(std::memory_order_acquire);
+    const auto first = published > RING_CAPACITY ? published - RING_CAPACITY : 0;
+
+    auto frames = std::vector<Frame>{};
+    frames.reserve(published - first);
+    for (auto i = first; i < published; ++i) {
+        const auto& slot = (*_ring)[i % RING_CAPACITY];
+        // The sequence the slot has once the i-th published frame is written to it, and before the next one is
+        const auto expected = 2 * (i / RING_CAPACITY + 1);
+        if (slot.sequence.load(std::memory_order_acquire) != expected) {
+            continue;
+        }
+        const auto frame = slot.frame;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Overwritten while copying, the frame is gone anyway
+        if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+            continue;
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+void Profiler::writeChromeTrace(std::ostream& stream) const {
+    constexpr auto CPU_THREAD = 0;
+    constexpr auto GPU_THREAD = 1;
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    stream << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << CPU_THREAD << R"(,"args":{"name":"CPU"}},)" << '\n';
+    stream << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << GPU_THREAD << R"(,"args":{"name":"GPU"}})";
+
+    for (const auto& frame : snapshot()) {
+        stream << ",\n" << R"({"name":"frame","cat":"frame","ph":"X","pid":0,"tid":)" << CPU_THREAD
+               << R"(,"ts":)" << toMicros(frame.startNanos) << R"(,"dur":)" << toMicros(frame.durationNanos)
+               << R"(,"args":{"index":)" << frame.index << "}}";
+
+        for (auto e = 0; e < frame.eventCount; ++e) {
+            const auto& event = frame.events[e];
+            stream << ",\n" << R"({"name":")" << event.name << R"(","cat":")" << (event.gpu ? "gpu" : "cpu")
+                   << R"(","ph":"X","pid":0,"tid":)" << (event.gpu ? GPU_THREAD : CPU_THREAD)
+                   << R"(,"ts":)" << toMicros(event.startNanos) << R"(,"dur":)" << toMicros(event.durationNanos);
+            if (event.view >= 0) {
+                stream << R"(,"args":{"view":)" << event.view << "}";
+            }
+            stream << "}";
+        }
+
+        stream << ",\n" << R"({"name":"counters","ph":"C","pid":0,"ts":)" << toMicros(frame.startNanos)
+               << R"(,"args":{"drawCalls":)" << frame.counters.drawCalls
+               << R"(,"stateChanges":)" << frame.counters.stateChanges
+               << R"(,"triangles":)" << frame.counters.triangles << "}}";
+    }
+    stream << "\n]}\n";
+}
+
+void Profiler::writeChromeTrace(const std::filesystem::path& path) const {
+    std::error_code err;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), err);
+    }
+    auto stream = std::ofstream{ path };
+    if (!stream) {
+        std::cerr << "Profiler: Failed to open " << path << '\n';
+        return;
+    }
+    writeChromeTrace(stream);
+}
+
+void Profiler::releaseQueries() {
+    for (auto& pending : _pending) {
+        if (!pending.queries.empty()) {
+            glDeleteQueries(static_cast<GLsizei>(pending.queries.size()), pending.queries.data());
+        }
+        pending.queries.clear();
+        pending.timings.clear();
+        pending.waiting = false;
+    }
+    _openGpuEvent = -1;
+}
+
+Profiler::Scope::Scope(const char* const name, const int view) {
+    const auto profiler = get();
+    if (profiler->_enabled) {
+        _event = profiler->pushEvent(name, view, false);
+    }
+}
+
+Profiler::Scope::~Scope() {
+    if (_event >= 0) {
+        const auto profiler = get();
+        auto& event = profiler->_current.events[_event];
+        event.durationNanos = profiler->now() - event.startNanos;
+    }
+}
+
+Profiler::GpuScope::GpuScope(const char* const name, const int view) {
+    const auto profiler = get();
+    if (!profiler->_enabled || profiler->_openGpuEvent >= 0) {
+        return;
+    }
+    const auto event = profiler->pushEvent(name, view, true);
+    if (event < 0) {
+        return;
+    }
+
+    auto& pending = profiler->_pending[profiler->_frameIndex % FRAME_LATENCY];
+    if (pending.timings.size() == pending.queries.size()) {
+        auto query = GLuint{ 0 };
+        glGenQueries(1, &query);
+        pending.queries.push_back(query);
+    }
+    const auto query = pending.queries[pending.timings.size()];
+    pending.timings.emplace_back(event, query);
+
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    profiler->_openGpuEvent = event;
+    _active = true;
+}
+
+Profiler::GpuScope::~GpuScope() {
+    if (_active) {
+        glEndQuery(GL_TIME_ELAPSED);
+        get()->_openGpuEvent = -1;
+    }
+}
@@ -11,19 +11,17 @@ glm::mat4 getPlanetTransform(
     const std::function<float(float)>& orbitX, const std::function<float(float)>& orbitY,
     const glm::vec3& orbitOrientation, const glm::vec3& orbitCenter
 ) {
-    // Center
-    auto transform = glm::translate(glm::mat4(1.0f), orbitCenter);
-    // Orientation
-    if (orbitOrientation != glm::vec3{ 0.0f, 0.0f, 1.0f }) {
-        const auto orientingAxis = glm::normalize(glm::cross(glm::vec3{ 0.0f, 0.0f, 1.0f }, orbitOrientation));
-        const auto orientingAngle = glm::acos(glm::normalize(orbitOrientation).z);
-        const auto orientingQuat = glm::angleAxis(orientingAngle, orientingAxis);
-        const auto orientingMat = glm::mat4_cast(orientingQuat);
-        transform *= orientingMat;
-    }
+    return getOrbitTransform(orbitOrientation, orbitCenter)
+        * getPlanetLocalTransform(revolveAngle, rotateAngle, tiltingAngle, planetRadius, orbitX, orbitY);
+}
+
+glm::mat4 getPlanetLocalTransform(
+    const float revolveAngle, const float rotateAngle, const float tiltingAngle, const float planetRadius,
+    const std::function<float(float)>& orbitX, const std::function<float(float)>& orbitY
+) {
     // Revolve
     const auto revolveVec = glm::vec3{ orbitX(revolveAngle), orbitY(revolveAngle), 0.0f };
-    transform = glm::translate(transform, revolveVec);
+    auto transform = glm::translate(glm::mat4(1.0f), revolveVec);
     // Tilt
     const auto tiltingAxis = glm::vec3{ 0.0f, 1.0f, 0.0f };
     const auto tiltingQuat = glm::angleAxis(tiltingAngle, tiltingAxis);
@@ -42,11 +40,13 @@ glm::mat4 getPlanetTransform(
 glm::mat4 getOrbitTransform(const glm::vec3& orbitOrientation, const glm::vec3& orbitCenter) {
     // Center
     auto transform = glm::translate(glm::mat4(1.0f), orbitCenter);
-    // Orientation
-    const auto orientingAxis = glm::normalize(glm::cross(glm::vec3{ 0.0f, 0.0f, 1.0f }, orbitOrientation));
-    const auto orientingAngle = glm::acos(glm::normalize(orbitOrientation).z);
-    const auto orientingQuat = glm::angleAxis(orientingAngle, orientingAxis);
-    const auto orientingMat = glm::mat4_cast(orientingQuat);
-    transform *= orientingMat;
+    // Orientation, there is no rotation axis when the orbit already faces up
+    if (orbitOrientation != glm::vec3{ 0.0f, 0.0f, 1.0f }) {
+        const auto orientingAxis = glm::normalize(glm::cross(glm::vec3{ 0.0f, 0.0f, 1.0f }, orbitOrientation));
+        const auto orientingAngle = glm::acos(glm::normalize(orbitOrientation).z);
+        const auto orientingQuat = glm::angleAxis(orientingAngle, orientingAxis);
+        const auto orientingMat = glm::mat4_cast(orientingQuat);
+        transform *= orientingMat;
+    }
     return transform;
 }
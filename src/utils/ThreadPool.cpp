@@ -0,0 +1,111 @@
+// Copyright (c) 2023. Minh Nguyen
+// All rights reserved.
+
+#include <algorithm>
+#include <exception>
+#include <latch>
+
+#include "utils/ThreadPool.h"
+
+namespace {
+    // Ranges per thread, a few more than one so that uneven ranges still keep every thread busy
+    constexpr auto RANGES_PER_THREAD = 4;
+}
+
+ThreadPool* ThreadPool::get() {
+    if (!_instance) {
+        // The calling thread takes part in the work as well
+        _instance = new ThreadPool{ std::max(std::thread::hardware_concurrency(), 2u) - 1 };
+    }
+    return _instance;
+}
+
+ThreadPool::ThreadPool(const unsigned threadCount) {
+    _workers.reserve(threadCount);
+    for (auto i = 0u; i < threadCount; ++i) {
+        _workers.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const auto lock = std::lock_guard(_mutex);
+        _stopping = true;
+    }
+    _available.notify_all();
+    // The jthreads join on destruction
+}
+
+void ThreadPool::parallelFor(const int begin, const int end, const std::function<void(int, int)>& task) {
+    if (end <= begin) {
+        return;
+    }
+    const auto count = end - begin;
+    const auto rangeCount = std::min(count, getThreadCount() * RANGES_PER_THREAD);
+    const auto rangeSize = (count + rangeCount - 1) / rangeCount;
+    const auto actualRangeCount = (count + rangeSize - 1) / rangeSize;
+
+    auto done = std::latch{ actualRangeCount };
+    auto failure = std::exception_ptr{};
+    auto failureMutex = std::mutex{};
+    const auto run = [&](const int first) {
+        try {
+            task(first, std::min(first + rangeSize, end));
+        } catch (...) {
+            const auto lock = std::lock_guard(failureMutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+        done.count_down();
+    };
+
+    {
+        const auto lock = std::lock_guard(_mutex);
+        for (auto first = begin + rangeSize; first < end; first += rangeSize) {
+            _tasks.emplace([&run, first] { run(first); });
+        }
+    }
+    _available.notify_all();
+
+    run(begin);
+    // Help with whatever is queued rather than sleeping on it, which also keeps nested calls from starving
+    while (!done.try_wait()) {
+        auto next = std::function<void()>{};
+        {
+            const auto lock = std::lock_guard(_mutex);
+            if (!_tasks.empty()) {
+                next = std::move(_tasks.front());
+                _tasks.pop();
+            }
+        }
+        if (!next) {
+            done.wait();
+            break;
+        }
+        next();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+int ThreadPool::getThreadCount() const {
+    return static_cast<int>(_workers.size()) + 1;
+}
+
+void ThreadPool::work() {
+    while (true) {
+        auto task = std::function<void()>{};
+        {
+            auto lock = std::unique_lock(_mutex);
+            _available.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+            if (_stopping && _tasks.empty()) {
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop();
+        }
+        task();
+    }
+}